@@ -0,0 +1,359 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+// Benchmarks for the hot paths of Minesweeper_Game and Board_Renderer.
+// Prints results as JSON in the same layout as Google Benchmark's
+// --benchmark_format=json, so runs can be compared over time.
+//
+// Options:
+//   --max-side N    Largest board side to run (default 10000)
+//   --min-time S    Keep repeating each benchmark for at least S seconds (default 0.2)
+//   --filter TEXT   Only run benchmarks whose name contains TEXT
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <functional>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "board_generator.h"
+#include "board_renderer.h"
+#include "chunked_game.h"
+#include "fixed_board.h"
+#include "mine_probability.h"
+#include "minesweeper_game.h"
+#include "move_log.h"
+#include "solver.h"
+
+using namespace std;
+
+// Benchmark Runner Class
+// Runs each benchmark until enough time has been measured and collects the
+// results as JSON
+class Benchmark_Runner {
+private:
+	double min_seconds;
+	string filter;
+	string results;		// JSON objects for the benchmarks run so far
+	int count;
+
+public:
+	Benchmark_Runner(double min_seconds_in, const string& filter_in) :
+		min_seconds(min_seconds_in), filter(filter_in), count(0) {}
+
+	// EFFECTS: Runs benchmark name. setup is not timed, and run returns the
+	// number of nanoseconds it took to make calls calls of the function being
+	// measured. items is the number of tiles (or moves) one call works on
+	void run(const string& name, size_t items, const function<void(void)>& setup,
+		const function<double(void)>& run, uint64_t calls = 1) {
+		if (name.find(filter) == string::npos) return;
+		double total_ns = 0;
+		uint64_t iterations = 0;
+		while (total_ns < min_seconds * 1e9 || iterations == 0) {
+			setup();
+			total_ns += run();
+			iterations += calls;
+		}
+		double ns = total_ns / iterations;
+		if (count++ > 0) results += ",\n";
+		results += "    {\n";
+		results += "      \"name\": \"" + name + "\",\n";
+		results += "      \"run_name\": \"" + name + "\",\n";
+		results += "      \"run_type\": \"iteration\",\n";
+		results += "      \"iterations\": " + to_string(iterations) + ",\n";
+		results += "      \"real_time\": " + to_string(ns) + ",\n";
+		results += "      \"cpu_time\": " + to_string(ns) + ",\n";
+		results += "      \"time_unit\": \"ns\",\n";
+		results += "      \"items_per_second\": " + to_string(items / (ns / 1e9)) + ",\n";
+		results += "      \"ns_per_item\": " + to_string(ns / items) + "\n";
+		results += "    }";
+		cerr << name << ": " << ns / 1e6 << " ms" << endl;
+	}
+
+	// EFFECTS: Prints every result as JSON
+	void print(void) const {
+		char date[64];
+		time_t now = time(nullptr);
+		strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+		cout << "{\n";
+		cout << "  \"context\": {\n";
+		cout << "    \"date\": \"" << date << "\",\n";
+		cout << "    \"executable\": \"minesweeper_benchmark\",\n";
+		cout << "    \"num_cpus\": " << thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+		cout << "    \"library_build_type\": \"release\"\n";
+#else
+		cout << "    \"library_build_type\": \"debug\"\n";
+#endif
+		cout << "  },\n";
+		cout << "  \"benchmarks\": [\n" << results << "\n  ]\n";
+		cout << "}" << endl;
+	}
+};
+
+// EFFECTS: Returns nanoseconds taken by f
+double time_ns(const function<void(void)>& f) {
+	auto start = chrono::steady_clock::now();
+	f();
+	auto end = chrono::steady_clock::now();
+	return chrono::duration<double, nano>(end - start).count();
+}
+
+// EFFECTS: Runs every benchmark for square boards of side tiles
+void run_board_benchmarks(Benchmark_Runner& runner, int side, int null_fd) {
+	const int densities[] = { 1, 5, 10, 20, 50, 90 };
+	size_t tiles = size_t(side) * side;
+	string size = to_string(side) + "x" + to_string(side);
+	uint64_t seed = 1;
+
+	// make_board() doesn't depend on the number of mines
+	{
+		Minesweeper_Game game(side, side, 1);
+		runner.run("make_board/" + size, tiles, [] {}, [&] {
+			return time_ns([&] { game.make_board(); });
+		});
+	}
+
+	for (int density : densities) {
+		int mines = int(max(size_t(1), tiles * density / 100));
+		string name = size + "/density:" + to_string(density);
+		Minesweeper_Game game(side, side, mines);
+
+		runner.run("place_mines/" + name, tiles, [&] {
+			game.set_seed(seed++);
+			game.make_board();
+		}, [&] {
+			return time_ns([&] { game.place_mines(); });
+		});
+
+		game.set_seed(seed++);
+		game.start_game();
+		runner.run("count_nearby_mines/" + name, tiles, [] {}, [&] {
+			return time_ns([&] { game.count_nearby_mines(); });
+		});
+		runner.run("look_for_mines_nearby/" + name, tiles, [] {}, [&] {
+			return time_ns([&] {
+				for (int row = 0; row < side; ++row) {
+					for (int col = 0; col < side; ++col) game.look_for_mines_nearby(game.Tile_at(row, col));
+				}
+			});
+		});
+
+		// Render a board with about half of it revealed, like a game in progress
+		for (int row = 0; row < side; row += 2) {
+			for (int col = 0; col < side; ++col) {
+				if (!game.has_mine(row, col)) game.reveal(row, col);
+			}
+		}
+		Board_Renderer renderer(null_fd);
+		runner.run("print_board/" + name, tiles, [] {}, [&] {
+			return time_ns([&] { renderer.draw(game, false); });
+		});
+	}
+
+	// Worst case reveal: one mine, so the first click opens the whole board
+	{
+		Minesweeper_Game game(side, side, 1);
+		runner.run("reveal_open_board/" + size, tiles, [&] {
+			game.set_seed(seed++);
+			game.start_game();
+		}, [&] {
+			int row = game.has_mine(0, 0) ? side - 1 : 0;
+			return time_ns([&] { game.reveal(row, row); });
+		});
+		volatile bool won = false;
+		runner.run("check_if_win/" + size, 1, [] {}, [&] {
+			return time_ns([&] {
+				for (int i = 0; i < 1000; ++i) won = game.check_if_win();
+			});
+		}, 1000);
+	}
+}
+
+// EFFECTS: Records a game played by the solver on a square board of side
+// tiles, then times replaying its move log
+void run_replay_benchmark(Benchmark_Runner& runner, int side) {
+	string path = "/tmp/minesweeper_benchmark_" + to_string(getpid()) + ".log";
+	Minesweeper_Game game(side, side, int(size_t(side) * side / 10));
+	game.set_seed(1);
+	game.start_game();
+	uint64_t moves = 0;
+	{
+		Move_Log_Writer log(path);
+		Minesweeper_Solver solver(true);
+		solver.new_game(game, 1);
+		while (game.state() == Game_State::IN_PROGRESS) {
+			if (solver.play_move(game).status == Move_Status::OK) {
+				log.record(game);
+				++moves;
+			}
+		}
+		log.finish(game);
+	}
+	runner.run("replay_move_log/" + to_string(side) + "x" + to_string(side), moves, [] {}, [&] {
+		Replay_Results results = replay_move_log(path);
+		if (!results.ok()) cerr << "Replay didn't match the recorded game" << endl;
+		return results.seconds * 1e9;
+	});
+	unlink(path.c_str());
+}
+
+// EFFECTS: Times playing whole games with the solver one after another on
+// the same game and solver, named name
+template <class Game>
+void time_back_to_back_games(Benchmark_Runner& runner, Game& game, const string& name) {
+	Minesweeper_Solver solver;
+	uint64_t seed = 1;
+	auto play_game = [&] {
+		game.new_game(seed);
+		solver.new_game(game, seed++);
+		while (game.state() == Game_State::IN_PROGRESS) solver.play_move(game);
+	};
+	// The first game makes the memory every game after it reuses
+	play_game();
+	runner.run(name, 1, [] {}, [&] {
+		return time_ns([&] {
+			for (int i = 0; i < 100; ++i) play_game();
+		});
+	}, 100);
+}
+
+// EFFECTS: Times starting a game and clearing the whole board by revealing
+// every safe tile that is still hidden, row by row, named name
+// Only the engine is timed, no player is deciding the moves
+template <class Game>
+void time_clearing_boards(Benchmark_Runner& runner, Game& game, const string& name) {
+	uint64_t seed = 1;
+	runner.run(name, 1, [] {}, [&] {
+		return time_ns([&] {
+			for (int i = 0; i < 100; ++i) {
+				game.new_game(seed++);
+				for (int row = 0; row < game.get_height(); ++row) {
+					for (int col = 0; col < game.get_width(); ++col) {
+						if (!game.has_mine(row, col) && !game.is_revealed(row, col)) game.reveal(row, col);
+					}
+				}
+			}
+		});
+	}, 100);
+}
+
+// EFFECTS: Times back to back games and clearing boards for the usual
+// beginner, intermediate, and expert boards, both on a Minesweeper_Game and
+// on their Fixed_Board
+void run_back_to_back_benchmarks(Benchmark_Runner& runner) {
+	for (const Board_Preset& preset : BOARD_PRESETS) {
+		string board = to_string(preset.width) + "x" + to_string(preset.height)
+			+ "/mines:" + to_string(preset.number_of_mines);
+		Minesweeper_Game game(preset.width, preset.height, preset.number_of_mines);
+		time_back_to_back_games(runner, game, "back_to_back_games/" + board);
+		time_clearing_boards(runner, game, "clear_board/" + board);
+		with_fixed_board(preset.width, preset.height, preset.number_of_mines, [&](auto board_type) {
+			typename decltype(board_type)::type fixed;
+			time_back_to_back_games(runner, fixed, "fixed_back_to_back_games/" + board);
+			time_clearing_boards(runner, fixed, "fixed_clear_board/" + board);
+		});
+	}
+}
+
+// EFFECTS: Records every board the solver sees while playing expert games,
+// then times working out the chance of a mine on each hidden tile of them
+// in order, like a player with the chances shown would
+void run_mine_probability_benchmarks(Benchmark_Runner& runner) {
+	vector<Minesweeper_Game> boards;
+	Minesweeper_Game game(30, 16, 99);
+	Minesweeper_Solver solver;
+	for (uint64_t seed = 1; seed <= 20; ++seed) {
+		game.new_game(seed);
+		solver.new_game(game, seed);
+		while (game.state() == Game_State::IN_PROGRESS) {
+			if (solver.play_move(game).status == Move_Status::OK) boards.push_back(game);
+		}
+	}
+	Thread_Pool pool;
+	Mine_Probability_Map map(&pool);
+	runner.run("mine_probabilities/30x16/mines:99", boards.size(), [] {}, [&] {
+		return time_ns([&] {
+			for (const Minesweeper_Game& board : boards) map.update(board);
+		});
+	});
+}
+
+// EFFECTS: Times starting a game and making the first move on a chunked
+// board of side tiles. Neither should depend on side
+void run_chunked_benchmarks(Benchmark_Runner& runner, int side) {
+	string size = to_string(side) + "x" + to_string(side);
+	Chunked_Minesweeper_Game game(side, side, 15);
+	uint64_t seed = 1;
+	runner.run("chunked_start_game/" + size, 1, [&] {
+		game.set_seed(seed++);
+	}, [&] {
+		return time_ns([&] { game.start_game(); });
+	});
+	runner.run("chunked_first_reveal/" + size, 1, [&] {
+		game.set_seed(seed++);
+		game.start_game();
+	}, [&] {
+		return time_ns([&] { game.reveal(side / 2, side / 2); });
+	});
+}
+
+// EFFECTS: Times finding boards that can be cleared without guessing, using
+// every hardware thread, for the usual beginner, intermediate, and expert
+// boards with the first click in the middle
+void run_no_guess_benchmarks(Benchmark_Runner& runner) {
+	const int boards[3][3] = { { 9, 9, 10 }, { 16, 16, 40 }, { 30, 16, 99 } };
+	Thread_Pool pool;
+	for (const int* board : boards) {
+		No_Guess_Generator generator(board[0], board[1], board[2], pool);
+		uint64_t seed = 1;
+		string name = "no_guess_board/" + to_string(board[0]) + "x" + to_string(board[1])
+			+ "/mines:" + to_string(board[2]);
+		runner.run(name, 1, [] {}, [&] {
+			No_Guess_Result result = generator.find_seed(seed++, board[1] / 2, board[0] / 2);
+			return result.seconds * 1e9;
+		});
+	}
+}
+
+// Main function
+int main(int argc, char** argv) {
+	int max_side = 10000;
+	double min_seconds = 0.2;
+	string filter;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--max-side" && has_value) max_side = atoi(argv[++i]);
+		else if (arg == "--min-time" && has_value) min_seconds = atof(argv[++i]);
+		else if (arg == "--filter" && has_value) filter = argv[++i];
+		else {
+			cerr << "Usage: " << argv[0] << " [--max-side N] [--min-time S] [--filter TEXT]" << endl;
+			return 1;
+		}
+	}
+
+	int null_fd = open("/dev/null", O_WRONLY);
+	Benchmark_Runner runner(min_seconds, filter);
+	for (int side = 10; side <= max_side; side *= 10) {
+		run_board_benchmarks(runner, side, null_fd);
+	}
+	for (int side = 100; side <= min(max_side, 1000); side *= 10) {
+		run_replay_benchmark(runner, side);
+	}
+	run_back_to_back_benchmarks(runner);
+	run_no_guess_benchmarks(runner);
+	run_mine_probability_benchmarks(runner);
+	run_chunked_benchmarks(runner, 1000);
+	run_chunked_benchmarks(runner, 2000000000);
+	close(null_fd);
+	runner.print();
+}
@@ -0,0 +1,120 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef BOARD_GENERATOR_H
+#define BOARD_GENERATOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "instrumentation.h"
+#include "minesweeper_game.h"
+#include "simulation.h"
+#include "solver.h"
+#include "thread_pool.h"
+
+// Result of a search for a board that can be cleared without guessing
+struct No_Guess_Result {
+	bool found;
+	uint64_t seed;			// Seed of the board found
+	uint64_t candidates;	// Number of boards tried (up to and including the one found)
+	double seconds;
+};
+
+// REQUIRES: game is first click safe and start_game() was just called
+// EFFECTS: Makes the first click at row and col, then lets solver play.
+// Returns true if solver cleared the board without guessing once
+inline bool solvable_without_guessing(Minesweeper_Game& game, Minesweeper_Solver& solver,
+	int row, int col) {
+	if (game.reveal(row, col).state != Game_State::IN_PROGRESS) return game.state() == Game_State::WON;
+	solver.new_game(game, 0);
+	uint64_t guesses = solver.statistics().guesses;
+	while (game.state() == Game_State::IN_PROGRESS) {
+		solver.play_move(game);
+		if (solver.statistics().guesses != guesses) return false;
+	}
+	return game.state() == Game_State::WON;
+}
+
+// No Guess Generator Class
+// Finds first click safe boards that the solver can clear from the first
+// click without guessing. Candidate boards are tried on every worker of a
+// thread pool, and each worker reuses one game and one solver for all of its
+// candidates.
+// Candidate i of a search uses seed simulation_seed(base_seed, i), and the
+// search returns the lowest i that works, so the board found only depends on
+// the base seed and the first click, not on the number of threads.
+class No_Guess_Generator {
+private:
+	// Everything one worker needs, aligned to a cache line
+	struct alignas(64) Worker {
+		Minesweeper_Game game;
+		Minesweeper_Solver solver;
+		Worker(int width, int height, int number_of_mines) :
+			game(width, height, number_of_mines), solver(false) {
+			game.set_first_click_safe(true);
+		}
+	};
+
+	Thread_Pool& pool;
+	std::vector<std::unique_ptr<Worker>> workers;
+
+public:
+	// Custom Constructor: Specify the board and the threads to search with
+	// Throws Improper_Dimensions or Improper_Number_of_Mines like Minesweeper_Game
+	No_Guess_Generator(int width, int height, int number_of_mines, Thread_Pool& pool_in) :
+		pool(pool_in) {
+		for (unsigned i = 0; i < pool.size(); ++i) {
+			workers.emplace_back(new Worker(width, height, number_of_mines));
+		}
+	}
+
+	// EFFECTS: Tries up to max_candidates boards whose first click is at row
+	// and col, and returns the seed of the first one that can be cleared
+	// without guessing
+	No_Guess_Result find_seed(uint64_t base_seed, int row, int col,
+		uint64_t max_candidates = 1000000) {
+		const uint64_t NONE = UINT64_MAX;
+		// Candidates are tried a round at a time, so the search stops soon
+		// after a board is found
+		const uint64_t round_size = 16 * uint64_t(pool.size());
+		std::atomic<uint64_t> best(NONE);
+		// This thread plays candidates too, and they aren't part of its game
+		MINESWEEPER_COUNT(Performance_Counters counters = game_counters());
+		auto start = std::chrono::steady_clock::now();
+		uint64_t round_start = 0;
+		while (best.load() == NONE && round_start < max_candidates) {
+			uint64_t count = std::min(round_size, max_candidates - round_start);
+			pool.parallel_for(count, 1, [&](unsigned worker, size_t begin, size_t end) {
+				Worker& w = *workers[worker];
+				for (size_t i = begin; i < end; ++i) {
+					uint64_t candidate = round_start + i;
+					// A lower candidate already worked
+					if (best.load(std::memory_order_relaxed) < candidate) return;
+					w.game.new_game(simulation_seed(base_seed, candidate));
+					if (!solvable_without_guessing(w.game, w.solver, row, col)) continue;
+					uint64_t current = best.load();
+					while (candidate < current && !best.compare_exchange_weak(current, candidate)) {}
+				}
+			});
+			round_start += count;
+		}
+		auto end = std::chrono::steady_clock::now();
+		MINESWEEPER_COUNT(game_counters() = counters);
+
+		No_Guess_Result result;
+		result.found = best.load() != NONE;
+		result.seed = result.found ? simulation_seed(base_seed, best.load()) : 0;
+		result.candidates = result.found ? best.load() + 1 : round_start;
+		result.seconds = std::chrono::duration<double>(end - start).count();
+		return result;
+	}
+};
+
+#endif
@@ -0,0 +1,344 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef BOARD_RENDERER_H
+#define BOARD_RENDERER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "instrumentation.h"
+
+// Board Renderer Class
+// Builds each frame of the board in one reusable buffer and writes it with a
+// single write(). When the output is a terminal, only tiles that changed since
+// the last frame are redrawn (using ANSI cursor addressing), and only the part
+// of the board that fits on the screen (the viewport) is drawn at all.
+// When the output is not a terminal, the whole board is written as plain text.
+//
+// The board passed to draw() must provide:
+//   int get_width() const
+//   int get_height() const
+//   char tile_glyph(int row, int col, bool game_over) const
+class Board_Renderer {
+private:
+	int fd;				// File descriptor frames are written to
+	bool use_ansi;		// True if fd is a terminal
+	std::string frame;	// Buffer for the frame being built, reused every frame
+	size_t bytes_written;	// Size of the last frame written
+
+	// Viewport: the part of the board shown on the screen
+	int top_row;		// Board row shown at the top of the viewport
+	int left_col;		// Board column shown at the left of the viewport
+	int view_rows;		// Number of board rows in the viewport
+	int view_cols;		// Number of board columns in the viewport
+	int focus_row;		// Tile the viewport must show, or -1 if none
+	int focus_col;
+	int label_width;	// Number of characters used by the row labels
+	int plain_rows;		// Largest plain text frame in rows and columns of
+	int plain_cols;		// tiles, or 0 for the whole board
+
+	// What the terminal is showing right now
+	bool screen_valid;	// False when the next frame must redraw everything
+	std::vector<char> on_screen;	// Glyph of each tile in the viewport, row by row
+	int prompt_line;	// Terminal line just below the board
+
+public:
+
+	// Default Constructor: Draws to standard output
+	Board_Renderer() : Board_Renderer(STDOUT_FILENO) {}
+
+	// Custom Constructor: Draws to file descriptor fd_in
+	explicit Board_Renderer(int fd_in) : fd(fd_in), use_ansi(isatty(fd_in) != 0),
+		bytes_written(0), top_row(0), left_col(0), view_rows(0), view_cols(0),
+		focus_row(-1), focus_col(-1), label_width(3), plain_rows(0), plain_cols(0),
+		screen_valid(false), prompt_line(1) {}
+
+	// EFFECTS: Draws board. If game_over is true, the whole board is shown
+	// including mines.
+	template <class Board>
+	void draw(const Board& board, bool game_over) {
+		MINESWEEPER_TIME_STAGE(Stage::RENDER);
+		frame.clear();
+		if (use_ansi) draw_ansi(board, game_over);
+		else draw_plain(board, game_over);
+		write_frame();
+	}
+
+	// EFFECTS: Makes sure the tile at row and col is inside the viewport on
+	// the next frame, scrolling as little as possible
+	void set_focus(int row, int col) {
+		focus_row = row;
+		focus_col = col;
+	}
+
+	// EFFECTS: Moves the viewport by the given number of rows and columns
+	void scroll(int rows, int cols) {
+		top_row += rows;
+		left_col += cols;
+		focus_row = -1;
+		focus_col = -1;
+	}
+
+	// EFFECTS: Limits plain text frames to a window of at most rows by cols
+	// tiles that follows the focus tile, like the viewport on a terminal
+	// Boards too big to print (see Chunked_Minesweeper_Game) need this. 0
+	// prints the whole board
+	void set_plain_window(int rows, int cols) {
+		plain_rows = rows;
+		plain_cols = cols;
+	}
+
+	// EFFECTS: Puts the terminal's cursor on the tile at row and col if it
+	// was in the viewport of the last frame, so a player picking tiles with
+	// the keys can see which one is picked. Does nothing if the output isn't
+	// a terminal
+	void place_cursor(int row, int col) {
+		if (!use_ansi || !screen_valid) return;
+		if (row < top_row || row >= top_row + view_rows || col < left_col || col >= left_col + view_cols) return;
+		frame.clear();
+		append_move_cursor(row - top_row + 2, label_width + 3 * (col - left_col) + 1);
+		write_frame();
+	}
+
+	// EFFECTS: Makes the next frame redraw the whole screen
+	void invalidate(void) {
+		screen_valid = false;
+	}
+
+	// EFFECTS: Returns number of bytes written for the last frame
+	size_t last_frame_size(void) const {
+		return bytes_written;
+	}
+
+private:
+	// EFFECTS: Appends the whole board as plain text, one line per row, or
+	// just the plain text window if one was set
+	template <class Board>
+	void draw_plain(const Board& board, bool game_over) {
+		int width = board.get_width();
+		int height = board.get_height();
+		if (plain_rows > 0 && plain_cols > 0) {
+			place_viewport(width, height, plain_rows, plain_cols);
+		}
+		else {
+			label_width = row_label_width(height);
+			top_row = 0;
+			left_col = 0;
+			view_rows = height;
+			view_cols = width;
+		}
+		append_column_labels(left_col, view_cols);
+		for (int row = top_row; row < top_row + view_rows; ++row) {
+			append_row_label(row);
+			for (int col = left_col; col < left_col + view_cols; ++col) {
+				frame += board.tile_glyph(row, col, game_over);
+				frame += "  ";
+			}
+			frame += '\n';
+		}
+		if (view_rows < height || view_cols < width) append_status_line(width, height);
+	}
+
+	// EFFECTS: Appends the tiles in the viewport that changed since the last
+	// frame, or the whole viewport if the screen has to be redrawn
+	template <class Board>
+	void draw_ansi(const Board& board, bool game_over) {
+		update_viewport(board.get_width(), board.get_height());
+		if (!screen_valid) {
+			// Clear the screen and draw every tile in the viewport
+			frame += "\x1b[H\x1b[2J";
+			append_column_labels(left_col, view_cols);
+			for (int r = 0; r < view_rows; ++r) {
+				append_row_label(top_row + r);
+				for (int c = 0; c < view_cols; ++c) {
+					char glyph = board.tile_glyph(top_row + r, left_col + c, game_over);
+					on_screen[size_t(r) * view_cols + c] = glyph;
+					frame += glyph;
+					frame += "  ";
+				}
+				frame += '\n';
+			}
+			append_status_line(board.get_width(), board.get_height());
+			screen_valid = true;
+		}
+		else {
+			// Only move the cursor when the changed tile isn't where the
+			// cursor already is or right after it (the gap between two
+			// tiles in a row is always two spaces)
+			int cursor_line = -1;
+			int cursor_column = -1;
+			for (int r = 0; r < view_rows; ++r) {
+				for (int c = 0; c < view_cols; ++c) {
+					char glyph = board.tile_glyph(top_row + r, left_col + c, game_over);
+					char& shown = on_screen[size_t(r) * view_cols + c];
+					if (glyph == shown) continue;
+					shown = glyph;
+					int line = r + 2;
+					int column = label_width + 3 * c + 1;
+					if (line == cursor_line && column == cursor_column + 2) frame += "  ";
+					else if (line != cursor_line || column != cursor_column) append_move_cursor(line, column);
+					frame += glyph;
+					cursor_line = line;
+					cursor_column = column + 1;
+				}
+			}
+		}
+		// Leave the cursor below the board and clear anything printed there
+		append_move_cursor(prompt_line, 1);
+		frame += "\x1b[J";
+	}
+
+	// EFFECTS: Works out the size and position of the viewport from the
+	// terminal size and the focus tile. Invalidates the screen if the
+	// viewport changed
+	void update_viewport(int width, int height) {
+		int terminal_rows = 24;
+		int terminal_cols = 80;
+		winsize size;
+		if (ioctl(fd, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+			terminal_rows = size.ws_row;
+			terminal_cols = size.ws_col;
+		}
+		// Leave room for the column labels, the status line, and two lines of prompts
+		place_viewport(width, height, std::max(1, terminal_rows - 4),
+			std::max(1, (terminal_cols - row_label_width(height)) / 3));
+		prompt_line = view_rows + 3;
+	}
+
+	// EFFECTS: Sizes the viewport to at most max_rows by max_cols tiles and
+	// moves it as little as possible to show the focus tile. Invalidates the
+	// screen if the viewport changed
+	void place_viewport(int width, int height, int max_rows, int max_cols) {
+		int new_label_width = row_label_width(height);
+		int new_rows = std::min(height, max_rows);
+		int new_cols = std::min(width, max_cols);
+		int new_top = top_row;
+		int new_left = left_col;
+		if (focus_row >= 0) {
+			if (focus_row < new_top) new_top = focus_row;
+			else if (focus_row >= new_top + new_rows) new_top = focus_row - new_rows + 1;
+			if (focus_col < new_left) new_left = focus_col;
+			else if (focus_col >= new_left + new_cols) new_left = focus_col - new_cols + 1;
+		}
+		new_top = std::max(0, std::min(new_top, height - new_rows));
+		new_left = std::max(0, std::min(new_left, width - new_cols));
+		if (new_rows != view_rows || new_cols != view_cols || new_top != top_row ||
+			new_left != left_col || new_label_width != label_width) {
+			view_rows = new_rows;
+			view_cols = new_cols;
+			top_row = new_top;
+			left_col = new_left;
+			label_width = new_label_width;
+			if (use_ansi) on_screen.assign(size_t(view_rows) * view_cols, 0);
+			screen_valid = false;
+		}
+	}
+
+	// EFFECTS: Returns number of characters used for row labels. Boards with
+	// less than 100 rows use 3, just like the column spacing
+	static int row_label_width(int height) {
+		int digits = 1;
+		for (int n = height - 1; n >= 10; n /= 10) ++digits;
+		return std::max(3, digits + 1);
+	}
+
+	// EFFECTS: Appends the line of column labels for count columns starting at
+	// column first. Each label is 3 characters wide, so columns past 99 show
+	// their last two digits
+	void append_column_labels(int first, int count) {
+		frame.append(size_t(label_width), ' ');
+		for (int col = first; col < first + count; ++col) {
+			if (col < 10) {
+				frame += char('0' + col);
+				frame += "  ";
+			}
+			else {
+				int last_two = col % 100;
+				frame += char('0' + last_two / 10);
+				frame += char('0' + last_two % 10);
+				frame += ' ';
+			}
+		}
+		frame += '\n';
+	}
+
+	// EFFECTS: Appends the label of row, padded to label_width characters
+	void append_row_label(int row) {
+		size_t start = frame.size();
+		append_number(row);
+		frame.append(label_width - (frame.size() - start), ' ');
+	}
+
+	// EFFECTS: Appends which part of the board is shown, if it isn't all shown
+	void append_status_line(int width, int height) {
+		if (view_rows < height || view_cols < width) {
+			frame += "Rows ";
+			append_number(top_row);
+			frame += '-';
+			append_number(top_row + view_rows - 1);
+			frame += " of ";
+			append_number(height);
+			frame += ", columns ";
+			append_number(left_col);
+			frame += '-';
+			append_number(left_col + view_cols - 1);
+			frame += " of ";
+			append_number(width);
+		}
+		frame += '\n';
+	}
+
+	// EFFECTS: Appends ANSI escape sequence that moves the cursor to line and
+	// column (both start at 1)
+	void append_move_cursor(int line, int column) {
+		frame += "\x1b[";
+		append_number(line);
+		frame += ';';
+		append_number(column);
+		frame += 'H';
+	}
+
+	// EFFECTS: Appends n in decimal
+	void append_number(long long n) {
+		char digits[24];
+		int length = 0;
+		bool negative = n < 0;
+		unsigned long long value = negative ? 0ULL - (unsigned long long)n : (unsigned long long)n;
+		do {
+			digits[length++] = char('0' + value % 10);
+			value /= 10;
+		} while (value != 0);
+		if (negative) frame += '-';
+		while (length > 0) frame += digits[--length];
+	}
+
+	// EFFECTS: Writes the frame to fd
+	// Note: cout is flushed first so prompts printed before the frame
+	// show up before it
+	void write_frame(void) {
+		std::cout.flush();
+		const char* data = frame.data();
+		size_t left = frame.size();
+		while (left > 0) {
+			ssize_t n = ::write(fd, data, left);
+			if (n < 0) {
+				if (errno == EINTR) continue;
+				break;
+			}
+			data += n;
+			left -= size_t(n);
+		}
+		bytes_written = frame.size() - left;
+		MINESWEEPER_COUNT(game_counters().add_frame(bytes_written));
+	}
+};
+
+#endif
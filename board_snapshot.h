@@ -0,0 +1,189 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef BOARD_SNAPSHOT_H
+#define BOARD_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "minesweeper_game.h"
+
+// Snapshot file layout (version 1), all numbers little-endian:
+//   Snapshot_Header (64 bytes)
+//   mine plane, revealed plane, flag plane: words_per_plane 64-bit words each,
+//   one bit per tile number as written by Minesweeper_Game::save_planes()
+// A 10000x10000 board takes about 37.5 MB.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "Snapshot files are little-endian and are read and written in place"
+#endif
+
+// Exceptions
+class Snapshot_File_Error {};	// File couldn't be opened, mapped, or written
+class Invalid_Snapshot {};		// File isn't a snapshot this version can read
+
+struct Snapshot_Header {
+	char magic[8];				// "MSWEEPER"
+	uint32_t version;
+	uint32_t header_size;		// Bytes before the first plane
+	uint32_t width;
+	uint32_t height;
+	uint32_t number_of_mines;
+	uint32_t reserved_0;
+	uint64_t seed;				// Seed the mines were placed with
+	uint64_t words_per_plane;
+	uint64_t reserved_1[2];
+};
+static_assert(sizeof(Snapshot_Header) == 64, "Snapshot_Header must stay 64 bytes");
+
+const char SNAPSHOT_MAGIC[8] = { 'M', 'S', 'W', 'E', 'E', 'P', 'E', 'R' };
+const uint32_t SNAPSHOT_VERSION = 1;
+
+// Mapped File Class
+// Owns an open file and a shared mapping of all of it, and releases both
+class Mapped_File {
+private:
+	int fd;
+	void* data;
+	size_t size;
+
+public:
+	// Custom Constructor: Maps the file at path. If writable, the file is
+	// created (or emptied) and resized to size_in bytes first; otherwise
+	// size_in is ignored and the whole file is mapped read-only
+	// Throws Snapshot_File_Error if the file can't be opened or mapped
+	Mapped_File(const std::string& path, bool writable, size_t size_in) :
+		fd(-1), data(MAP_FAILED), size(size_in) {
+		fd = writable ? open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+			: open(path.c_str(), O_RDONLY);
+		if (fd < 0) throw Snapshot_File_Error();
+		if (writable) {
+			if (ftruncate(fd, off_t(size)) != 0) close_and_throw();
+		}
+		else {
+			struct stat info;
+			if (fstat(fd, &info) != 0) close_and_throw();
+			size = size_t(info.st_size);
+		}
+		if (size == 0) return;
+		data = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+			MAP_SHARED, fd, 0);
+		if (data == MAP_FAILED) close_and_throw();
+	}
+
+	// Destructor
+	~Mapped_File() {
+		if (data != MAP_FAILED) munmap(data, size);
+		if (fd >= 0) close(fd);
+	}
+
+	Mapped_File(const Mapped_File&) = delete;
+	Mapped_File& operator=(const Mapped_File&) = delete;
+
+	// EFFECTS: Returns pointer to the first byte of the file
+	unsigned char* bytes(void) const {
+		return static_cast<unsigned char*>(data);
+	}
+
+	// EFFECTS: Returns size of the file in bytes
+	size_t file_size(void) const {
+		return size;
+	}
+
+	// EFFECTS: Tells the kernel the mapping will be read from front to back
+	void expect_sequential_access(void) const {
+		if (data != MAP_FAILED) madvise(data, size, MADV_SEQUENTIAL);
+	}
+
+	// EFFECTS: Writes changes to the file back to disk, throws
+	// Snapshot_File_Error if that fails
+	void sync(void) const {
+		if (data != MAP_FAILED && msync(data, size, MS_SYNC) != 0) throw Snapshot_File_Error();
+	}
+
+private:
+	// EFFECTS: Closes the file and throws Snapshot_File_Error
+	void close_and_throw(void) {
+		close(fd);
+		fd = -1;
+		throw Snapshot_File_Error();
+	}
+};
+
+// EFFECTS: Returns size in bytes of a snapshot of game
+inline size_t snapshot_size(const Minesweeper_Game& game) {
+	return sizeof(Snapshot_Header) + 3 * game.words_per_plane() * sizeof(uint64_t);
+}
+
+// EFFECTS: Saves game to the file at path
+// Note: The planes are written straight into a mapping of a temporary file,
+// which then replaces path, so a crash never leaves half a snapshot behind
+inline void save_snapshot(const Minesweeper_Game& game, const std::string& path) {
+	std::string temporary_path = path + ".tmp";
+	{
+		Mapped_File file(temporary_path, true, snapshot_size(game));
+		Snapshot_Header header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+		header.version = SNAPSHOT_VERSION;
+		header.header_size = sizeof(Snapshot_Header);
+		header.width = uint32_t(game.get_width());
+		header.height = uint32_t(game.get_height());
+		header.number_of_mines = uint32_t(game.get_number_of_mines());
+		header.seed = game.get_seed();
+		header.words_per_plane = game.words_per_plane();
+		std::memcpy(file.bytes(), &header, sizeof(header));
+
+		uint64_t* planes = reinterpret_cast<uint64_t*>(file.bytes() + sizeof(header));
+		size_t words = game.words_per_plane();
+		game.save_planes(planes, planes + words, planes + 2 * words);
+		file.sync();
+	}
+	if (std::rename(temporary_path.c_str(), path.c_str()) != 0) throw Snapshot_File_Error();
+}
+
+// EFFECTS: Returns the game saved in the file at path, ready to carry on
+// playing. Throws Snapshot_File_Error if the file can't be read,
+// Invalid_Snapshot if it isn't a valid snapshot
+// Note: The file is mapped rather than read, so its pages are only loaded as
+// the board is filled in from them
+inline std::unique_ptr<Minesweeper_Game> load_snapshot(const std::string& path) {
+	Mapped_File file(path, false, 0);
+	if (file.file_size() < sizeof(Snapshot_Header)) throw Invalid_Snapshot();
+	file.expect_sequential_access();
+	Snapshot_Header header;
+	std::memcpy(&header, file.bytes(), sizeof(header));
+	if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+		|| header.version != SNAPSHOT_VERSION
+		|| header.header_size != sizeof(Snapshot_Header)) {
+		throw Invalid_Snapshot();
+	}
+	if (header.width > uint32_t(INT32_MAX) || header.height > uint32_t(INT32_MAX)
+		|| header.number_of_mines > uint32_t(INT32_MAX)) {
+		throw Invalid_Snapshot();
+	}
+
+	std::unique_ptr<Minesweeper_Game> game(new Minesweeper_Game(int(header.width),
+		int(header.height), int(header.number_of_mines)));
+	if (header.words_per_plane != game->words_per_plane()
+		|| file.file_size() != snapshot_size(*game)) {
+		throw Invalid_Snapshot();
+	}
+	game->set_seed(header.seed);
+	const uint64_t* planes = reinterpret_cast<const uint64_t*>(file.bytes() + sizeof(header));
+	size_t words = game->words_per_plane();
+	if (!game->load_planes(planes, planes + words, planes + 2 * words)) throw Invalid_Snapshot();
+	return game;
+}
+
+#endif
@@ -0,0 +1,499 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef CHUNKED_GAME_H
+#define CHUNKED_GAME_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "minesweeper_game.h"
+
+// Chunked Minesweeper Class
+// The same game as Minesweeper_Game, for boards far too big to hold in memory
+// (up to 2^31 - 1 tiles on a side). The board is split into CHUNK_SIZE x
+// CHUNK_SIZE chunks. A chunk's mines depend only on the seed and where the
+// chunk is, so a chunk is only made when a move or the renderer first needs
+// it, and starting a game takes the same time on any size of board.
+// At most max_resident_chunks chunks are kept in memory. When another one is
+// needed the least recently used chunk is dropped. If the player revealed or
+// flagged any of its tiles, only those bits are kept (see Stored_Chunk), since
+// its mines and numbers can be made again from the seed.
+// Note: Stored chunks stay in memory and max_resident_chunks doesn't limit
+// them, so memory still grows with the area the player has touched (512
+// bytes per chunk with a revealed tile, 1 KB with a flag too).
+// Instead of a number of mines, each chunk gets mine_percent percent of its
+// tiles as mines.
+class Chunked_Minesweeper_Game {
+public:
+	static constexpr int CHUNK_SIZE = 64;
+
+	// Fewest and most percent of mines a board can have. Below about 10%, the
+	// tiles with no mines around them join up into one area that never ends,
+	// so a single reveal would try to open most of the board
+	static constexpr int MIN_MINE_PERCENT = 12;
+	static constexpr int MAX_MINE_PERCENT = 90;
+
+private:
+	// Each tile is packed into a single byte, the same way as Minesweeper_Game
+	typedef unsigned char Tile;
+	static const Tile NEARBY_MINES_MASK = 0x0F;
+	static const Tile MINE = 0x10;
+	static const Tile REVEALED = 0x20;
+	static const Tile FLAGGED = 0x40;
+	static const size_t CHUNK_TILES = size_t(CHUNK_SIZE) * CHUNK_SIZE;
+
+	// A chunk in memory. Tile (r, c) of the chunk is tiles[r * CHUNK_SIZE + c].
+	// Tiles past the edge of the board are left at 0 and never used
+	struct Chunk {
+		uint64_t key;		// See chunk_key()
+		std::list<Chunk*>::iterator lru_position;
+		Tile tiles[CHUNK_TILES];
+	};
+
+	// What is kept of a chunk that was dropped from memory: one word per row
+	// with bit c set if tile c of the row is revealed, then (only if any tile
+	// was flagged) one word per row for the flags. These are never dropped
+	typedef std::vector<uint64_t> Stored_Chunk;
+
+	int width;
+	int height;
+	int mine_percent;
+	uint64_t total_number_of_tiles;
+	uint64_t number_of_mines;
+	uint64_t unrevealed_safe_tiles;
+	bool hit_mine;
+	uint64_t seed;
+	Move previous_move;
+
+	// The cache is changed when tiles are looked at, so it is mutable
+	size_t max_resident_chunks;
+	mutable std::unordered_map<uint64_t, std::unique_ptr<Chunk>> resident;
+	mutable std::list<Chunk*> lru;		// Resident chunks, most recently used first
+	mutable std::unordered_map<uint64_t, Stored_Chunk> store;
+	mutable Chunk* last_chunk;			// Chunk used last, checked before resident
+	mutable uint64_t chunks_made;
+
+	// Work queue for reveal(): (row, col) of every tile it revealed
+	std::vector<std::pair<int, int>> revealed_tiles;
+
+public:
+
+	// Custom Constructor: Specify width, height, percent of each chunk that
+	// is mines (MIN_MINE_PERCENT to MAX_MINE_PERCENT), and how many chunks can
+	// be in memory at once (at least 16)
+	// Throws Improper_Dimensions or Improper_Number_of_Mines if they don't
+	// make a playable board
+	Chunked_Minesweeper_Game(int width_in, int height_in, int mine_percent_in,
+		size_t max_resident_chunks_in = 4096) :
+		width(width_in), height(height_in), mine_percent(mine_percent_in),
+		total_number_of_tiles(uint64_t(width_in) * uint64_t(height_in)),
+		number_of_mines(0), unrevealed_safe_tiles(0), hit_mine(false), seed(0),
+		previous_move{0, 0, Move_Action::REVEAL},
+		max_resident_chunks(std::max(size_t(16), max_resident_chunks_in)),
+		last_chunk(nullptr), chunks_made(0) {
+		if (width_in <= 1 || height_in <= 1) throw Improper_Dimensions();
+		if (mine_percent_in < MIN_MINE_PERCENT || mine_percent_in > MAX_MINE_PERCENT) {
+			throw Improper_Number_of_Mines();
+		}
+		number_of_mines = count_mines();
+		if (number_of_mines == 0) throw Improper_Number_of_Mines();
+		unrevealed_safe_tiles = total_number_of_tiles - number_of_mines;
+		set_seed(Minesweeper_Game::random_seed());
+	}
+
+	Chunked_Minesweeper_Game(const Chunked_Minesweeper_Game&) = delete;
+	Chunked_Minesweeper_Game& operator=(const Chunked_Minesweeper_Game&) = delete;
+
+	// EFFECTS: Sets the seed the mines are worked out from
+	void set_seed(uint64_t seed_in) {
+		seed = seed_in;
+	}
+
+	// EFFECTS: Returns seed the mines are worked out from
+	uint64_t get_seed(void) const {
+		return seed;
+	}
+
+	// EFFECTS: Starts a new game with the current seed
+	// Note: No chunk is made until it is needed, so this doesn't depend on
+	// the size of the board
+	void start_game(void) {
+		resident.clear();
+		lru.clear();
+		store.clear();
+		last_chunk = nullptr;
+		chunks_made = 0;
+		revealed_tiles.clear();
+		unrevealed_safe_tiles = total_number_of_tiles - number_of_mines;
+		hit_mine = false;
+	}
+
+	// EFFECTS: Reveals the tile at row and col, the same way as
+	// Minesweeper_Game::reveal()
+	Move_Result reveal(int row, int col) {
+		MINESWEEPER_TIME_STAGE(Stage::MOVE);
+		Move_Status status = check_move(row, col);
+		if (status != Move_Status::OK) return Move_Result{status, state(), 0};
+		Tile& chosen = tile_at(row, col);
+		if (chosen & FLAGGED) return Move_Result{Move_Status::FLAGGED, state(), 0};
+		previous_move = Move{row, col, Move_Action::REVEAL};
+		if (chosen & MINE) {
+			chosen |= REVEALED;
+			revealed_tiles.clear();
+			revealed_tiles.emplace_back(row, col);
+			hit_mine = true;
+			return Move_Result{Move_Status::OK, Game_State::LOST, 1};
+		}
+		size_t tiles_revealed = tile_reveal_func(row, col);
+		return Move_Result{Move_Status::OK, state(), tiles_revealed};
+	}
+
+	// EFFECTS: Flags the tile at row and col if it isn't flagged, otherwise
+	// removes the flag
+	Move_Result flag(int row, int col) {
+		MINESWEEPER_TIME_STAGE(Stage::MOVE);
+		Move_Status status = check_move(row, col);
+		if (status != Move_Status::OK) return Move_Result{status, state(), 0};
+		tile_at(row, col) ^= FLAGGED;
+		revealed_tiles.clear();
+		previous_move = Move{row, col, Move_Action::FLAG};
+		return Move_Result{Move_Status::OK, state(), 0};
+	}
+
+	// EFFECTS: Returns state of the game
+	Game_State state(void) const {
+		if (hit_mine) return Game_State::LOST;
+		if (check_if_win()) return Game_State::WON;
+		return Game_State::IN_PROGRESS;
+	}
+
+	// EFFECTS: Returns true if every tile without a mine has been revealed
+	bool check_if_win(void) const {
+		return unrevealed_safe_tiles == 0;
+	}
+
+	// EFFECTS: Returns number of tiles without a mine that are not yet revealed
+	uint64_t number_of_unrevealed_safe_tiles(void) const {
+		return unrevealed_safe_tiles;
+	}
+
+	// EFFECTS: Returns number of tiles on the board that have been revealed
+	uint64_t revealed_cells(void) const {
+		return total_number_of_tiles - number_of_mines - unrevealed_safe_tiles
+			+ (hit_mine ? 1 : 0);
+	}
+
+	// REQUIRES: A move has been made since start_game()
+	// EFFECTS: Returns the last move that was made (and not refused)
+	Move last_move(void) const {
+		return previous_move;
+	}
+
+	// EFFECTS: Returns true if the tile at row and col has been revealed
+	bool is_revealed(int row, int col) const {
+		return tile_at(row, col) & REVEALED;
+	}
+
+	// EFFECTS: Returns true if the tile at row and col is flagged
+	bool is_flagged(int row, int col) const {
+		return tile_at(row, col) & FLAGGED;
+	}
+
+	// REQUIRES: Tile at row and col has been revealed
+	// EFFECTS: Returns number of mines next to the tile at row and col
+	int number_of_nearby_mines(int row, int col) const {
+		assert(is_revealed(row, col));
+		return tile_at(row, col) & NEARBY_MINES_MASK;
+	}
+
+	// EFFECTS: Returns true if the tile at row and col has a mine
+	// Note: Players shouldn't look at this until the game is over
+	bool has_mine(int row, int col) const {
+		return tile_at(row, col) & MINE;
+	}
+
+	// EFFECTS: Returns character shown for the tile at row and col, the same
+	// way as Minesweeper_Game::tile_glyph()
+	// Note: Tiles of chunks that were never made are all hidden, so drawing
+	// them doesn't make the chunk unless game_over is true
+	char tile_glyph(int row, int col, bool game_over) const {
+		if (!game_over && !chunk_exists(row / CHUNK_SIZE, col / CHUNK_SIZE)) return '?';
+		Tile current_tile = tile_at(row, col);
+		if (game_over) {
+			if (current_tile & MINE) return 'X';
+		}
+		else if (!(current_tile & REVEALED)) {
+			return (current_tile & FLAGGED) ? 'F' : '?';
+		}
+		int number_of_nearby_mines = current_tile & NEARBY_MINES_MASK;
+		if (number_of_nearby_mines == 0) return ' ';
+		return char('0' + number_of_nearby_mines);
+	}
+
+	// EFFECTS: Returns width of the board
+	int get_width(void) const {
+		return width;
+	}
+
+	// EFFECTS: Returns height of the board
+	int get_height(void) const {
+		return height;
+	}
+
+	// EFFECTS: Returns number of mines on the board
+	uint64_t get_number_of_mines(void) const {
+		return number_of_mines;
+	}
+
+	// EFFECTS: Returns true if row and col are in bounds of the board
+	bool valid_dimensions_chosen(int row, int col) const {
+		return row >= 0 && row < height && col >= 0 && col < width;
+	}
+
+	// EFFECTS: Returns number of chunks in memory
+	size_t resident_chunks(void) const {
+		return resident.size();
+	}
+
+	// EFFECTS: Returns number of chunks dropped from memory that the player
+	// had changed
+	size_t stored_chunks(void) const {
+		return store.size();
+	}
+
+	// EFFECTS: Returns number of times a chunk was made since start_game()
+	// (including chunks made again after being dropped)
+	uint64_t number_of_chunks_made(void) const {
+		return chunks_made;
+	}
+
+private:
+	// EFFECTS: Returns OK if a move can be made on the tile at row and col
+	Move_Status check_move(int row, int col) const {
+		if (state() != Game_State::IN_PROGRESS) return Move_Status::GAME_OVER;
+		if (!valid_dimensions_chosen(row, col)) return Move_Status::OUT_OF_BOUNDS;
+		if (tile_at(row, col) & REVEALED) return Move_Status::ALREADY_REVEALED;
+		return Move_Status::OK;
+	}
+
+	// REQUIRES: tile at row and col is on the board, not revealed, and has no mine
+	// EFFECTS: Reveals the tile and spreads outward the same way as
+	// Minesweeper_Game::tile_reveal_func(). Returns number of tiles revealed
+	// Note: The chunk a tile is in can be dropped whenever another chunk is
+	// made, so a Tile& is never kept past the next call to tile_at()
+	size_t tile_reveal_func(int row, int col) {
+		static const int row_offsets[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+		static const int col_offsets[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+		MINESWEEPER_TIME_STAGE(Stage::REVEAL);
+		MINESWEEPER_COUNT(size_t cells_visited = 1; size_t max_queue_depth = 1);
+		revealed_tiles.clear();
+		tile_at(row, col) |= REVEALED;
+		revealed_tiles.emplace_back(row, col);
+		for (size_t next = 0; next < revealed_tiles.size(); ++next) {
+			int current_row = revealed_tiles[next].first;
+			int current_col = revealed_tiles[next].second;
+			if (tile_at(current_row, current_col) & NEARBY_MINES_MASK) continue;
+			for (int i = 0; i < 8; ++i) {
+				int r = current_row + row_offsets[i];
+				int c = current_col + col_offsets[i];
+				if (!valid_dimensions_chosen(r, c)) continue;
+				Tile& neighbour = tile_at(r, c);
+				if (neighbour & (REVEALED | FLAGGED)) continue;
+				neighbour |= REVEALED;
+				revealed_tiles.emplace_back(r, c);
+			}
+			MINESWEEPER_COUNT(cells_visited += 8;
+				max_queue_depth = std::max(max_queue_depth, revealed_tiles.size() - next - 1));
+		}
+		MINESWEEPER_COUNT(game_counters().add_reveal_pass(cells_visited, max_queue_depth));
+		unrevealed_safe_tiles -= revealed_tiles.size();
+		return revealed_tiles.size();
+	}
+
+	// EFFECTS: Returns key of the chunk at chunk_row and chunk_col
+	static uint64_t chunk_key(int chunk_row, int chunk_col) {
+		return (uint64_t(uint32_t(chunk_row)) << 32) | uint32_t(chunk_col);
+	}
+
+	// EFFECTS: Returns number of rows (or columns) of chunk number index that
+	// are on a board of size tiles
+	static int chunk_extent(int index, int size) {
+		return std::max(0, std::min(CHUNK_SIZE, size - index * CHUNK_SIZE));
+	}
+
+	// EFFECTS: Returns number of mines in a chunk with tiles tiles on the board
+	uint64_t mines_in_chunk(uint64_t tiles) const {
+		return tiles * uint64_t(mine_percent) / 100;
+	}
+
+	// EFFECTS: Returns number of mines on the whole board
+	// Note: Chunks only differ along the last row and column of chunks, so
+	// this adds up four kinds of chunk instead of every chunk
+	uint64_t count_mines(void) const {
+		uint64_t full_rows = uint64_t(height / CHUNK_SIZE);
+		uint64_t full_cols = uint64_t(width / CHUNK_SIZE);
+		uint64_t last_rows = uint64_t(height % CHUNK_SIZE);
+		uint64_t last_cols = uint64_t(width % CHUNK_SIZE);
+		const uint64_t size = CHUNK_SIZE;
+		return full_rows * full_cols * mines_in_chunk(size * size)
+			+ full_rows * (last_cols ? mines_in_chunk(size * last_cols) : 0)
+			+ full_cols * (last_rows ? mines_in_chunk(last_rows * size) : 0)
+			+ (last_rows && last_cols ? mines_in_chunk(last_rows * last_cols) : 0);
+	}
+
+	// EFFECTS: Writes where the mines of the chunk at chunk_row and chunk_col
+	// are into rows: bit c of rows[r] is set if tile (r, c) of the chunk has a
+	// mine. Chunks off the board have no mines
+	// Note: Uses Floyd's sampling with a generator seeded from the game's seed
+	// and the chunk's key, so a chunk always gets the same mines
+	void make_mines(int chunk_row, int chunk_col, uint64_t rows[CHUNK_SIZE]) const {
+		std::fill(rows, rows + CHUNK_SIZE, 0);
+		if (chunk_row < 0 || chunk_col < 0) return;
+		int chunk_height = chunk_extent(chunk_row, height);
+		int chunk_width = chunk_extent(chunk_col, width);
+		if (chunk_height == 0 || chunk_width == 0) return;
+		uint64_t tiles = uint64_t(chunk_height) * chunk_width;
+		uint64_t mines = mines_in_chunk(tiles);
+		std::mt19937_64 rng(mix_64(seed ^ mix_64(chunk_key(chunk_row, chunk_col))));
+		for (uint64_t j = tiles - mines; j < tiles; ++j) {
+			uint64_t x = random_0_to_x(rng, j);
+			if ((rows[x / chunk_width] >> (x % chunk_width)) & 1) x = j;
+			rows[x / chunk_width] |= uint64_t(1) << (x % chunk_width);
+		}
+	}
+
+	// EFFECTS: Returns true if the chunk at chunk_row and chunk_col is in
+	// memory or stored, i.e. has been made before
+	bool chunk_exists(int chunk_row, int chunk_col) const {
+		uint64_t key = chunk_key(chunk_row, chunk_col);
+		return (last_chunk && last_chunk->key == key) || resident.count(key) || store.count(key);
+	}
+
+	// REQUIRES: row and col are on the board
+	// EFFECTS: Returns the tile at row and col, making its chunk if needed
+	Tile& tile_at(int row, int col) const {
+		Chunk& chunk = chunk_at(row / CHUNK_SIZE, col / CHUNK_SIZE);
+		return chunk.tiles[size_t(row % CHUNK_SIZE) * CHUNK_SIZE + col % CHUNK_SIZE];
+	}
+
+	// EFFECTS: Returns the chunk at chunk_row and chunk_col, making it (and
+	// dropping the least recently used chunk) if it isn't in memory
+	Chunk& chunk_at(int chunk_row, int chunk_col) const {
+		uint64_t key = chunk_key(chunk_row, chunk_col);
+		if (last_chunk && last_chunk->key == key) return *last_chunk;
+		auto found = resident.find(key);
+		if (found != resident.end()) {
+			Chunk* chunk = found->second.get();
+			lru.splice(lru.begin(), lru, chunk->lru_position);
+			last_chunk = chunk;
+			return *chunk;
+		}
+
+		// Reuse the memory of the chunk being dropped
+		std::unique_ptr<Chunk> chunk;
+		if (resident.size() >= max_resident_chunks) {
+			Chunk* victim = lru.back();
+			lru.pop_back();
+			save_chunk(*victim);
+			auto victim_entry = resident.find(victim->key);
+			chunk = std::move(victim_entry->second);
+			resident.erase(victim_entry);
+		}
+		else chunk.reset(new Chunk);
+		chunk->key = key;
+		make_chunk(chunk_row, chunk_col, *chunk);
+		lru.push_front(chunk.get());
+		chunk->lru_position = lru.begin();
+		last_chunk = chunk.get();
+		resident.emplace(key, std::move(chunk));
+		return *last_chunk;
+	}
+
+	// EFFECTS: Fills in the tiles of chunk: its mines, the number of nearby
+	// mines of each tile (which needs the mines of the eight chunks around
+	// it), and whatever the player had revealed or flagged if it was stored
+	void make_chunk(int chunk_row, int chunk_col, Chunk& chunk) const {
+		MINESWEEPER_TIME_STAGE(Stage::PLACE_MINES);
+		++chunks_made;
+		// Mines of the chunk and its neighbours as one (CHUNK_SIZE + 2)
+		// square of bytes, so every tile of the chunk has all eight neighbours
+		const int side = CHUNK_SIZE + 2;
+		unsigned char mines[side * side];
+		uint64_t rows[CHUNK_SIZE];
+		for (int dr = -1; dr <= 1; ++dr) {
+			for (int dc = -1; dc <= 1; ++dc) {
+				make_mines(chunk_row + dr, chunk_col + dc, rows);
+				// Part of this chunk that lands in the square
+				int first_row = dr < 0 ? CHUNK_SIZE - 1 : 0;
+				int last_row = dr > 0 ? 0 : CHUNK_SIZE - 1;
+				int first_col = dc < 0 ? CHUNK_SIZE - 1 : 0;
+				int last_col = dc > 0 ? 0 : CHUNK_SIZE - 1;
+				for (int r = first_row; r <= last_row; ++r) {
+					int square_row = r + 1 + dr * CHUNK_SIZE;
+					for (int c = first_col; c <= last_col; ++c) {
+						int square_col = c + 1 + dc * CHUNK_SIZE;
+						mines[square_row * side + square_col] = (rows[r] >> c) & 1;
+					}
+				}
+			}
+		}
+		for (int r = 0; r < CHUNK_SIZE; ++r) {
+			const unsigned char* above = mines + r * side;
+			const unsigned char* current_row = above + side;
+			const unsigned char* below = current_row + side;
+			for (int c = 0; c < CHUNK_SIZE; ++c) {
+				int count = above[c] + above[c + 1] + above[c + 2] + current_row[c]
+					+ current_row[c + 2] + below[c] + below[c + 1] + below[c + 2];
+				chunk.tiles[size_t(r) * CHUNK_SIZE + c] = Tile((current_row[c + 1] ? MINE : 0) | count);
+			}
+		}
+
+		auto stored = store.find(chunk.key);
+		if (stored == store.end()) return;
+		const Stored_Chunk& bits = stored->second;
+		for (int r = 0; r < CHUNK_SIZE; ++r) {
+			for (int c = 0; c < CHUNK_SIZE; ++c) {
+				Tile& tile = chunk.tiles[size_t(r) * CHUNK_SIZE + c];
+				if ((bits[r] >> c) & 1) tile |= REVEALED;
+				if (bits.size() > size_t(CHUNK_SIZE) && ((bits[CHUNK_SIZE + r] >> c) & 1)) tile |= FLAGGED;
+			}
+		}
+		store.erase(stored);
+	}
+
+	// EFFECTS: Keeps the revealed and flagged bits of chunk before it is
+	// dropped, unless the player never changed it
+	void save_chunk(const Chunk& chunk) const {
+		uint64_t revealed[CHUNK_SIZE];
+		uint64_t flagged[CHUNK_SIZE];
+		bool any_revealed = false;
+		bool any_flagged = false;
+		for (int r = 0; r < CHUNK_SIZE; ++r) {
+			revealed[r] = 0;
+			flagged[r] = 0;
+			for (int c = 0; c < CHUNK_SIZE; ++c) {
+				Tile tile = chunk.tiles[size_t(r) * CHUNK_SIZE + c];
+				if (tile & REVEALED) revealed[r] |= uint64_t(1) << c;
+				if (tile & FLAGGED) flagged[r] |= uint64_t(1) << c;
+			}
+			any_revealed = any_revealed || revealed[r];
+			any_flagged = any_flagged || flagged[r];
+		}
+		if (!any_revealed && !any_flagged) return;
+		Stored_Chunk& bits = store[chunk.key];
+		bits.assign(revealed, revealed + CHUNK_SIZE);
+		if (any_flagged) bits.insert(bits.end(), flagged, flagged + CHUNK_SIZE);
+	}
+};
+
+#endif
@@ -0,0 +1,40 @@
+# Minesweeper
+# By: Benjamin Yee
+# Email: yeebenja@umich.edu
+# LinkedIn: https://www.linkedin.com/in/yeebenja
+# GitHub: https://github.com/yeebenja
+
+# Runs the instrumented executables to write a PGO profile. Called by the
+# pgo-train target with MINESWEEPER, BENCHMARK, PGO_DIR, LLVM_PROFDATA and
+# CLANG set.
+
+file(REMOVE_RECURSE "${PGO_DIR}")
+file(MAKE_DIRECTORY "${PGO_DIR}")
+if(CLANG)
+	set(ENV{LLVM_PROFILE_FILE} "${PGO_DIR}/minesweeper-%p.profraw")
+endif()
+
+# EFFECTS: Runs the given command line and stops if it fails
+function(train)
+	execute_process(COMMAND ${ARGN} RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "Training run failed: ${ARGN}")
+	endif()
+endfunction()
+
+# Beginner, Intermediate and Expert boards played by the solver, then by
+# the random player, then one large board
+train("${MINESWEEPER}" --seed 1 --batch 200000 9 9 10)
+train("${MINESWEEPER}" --seed 2 --batch 50000 16 16 40)
+train("${MINESWEEPER}" --seed 3 --batch 20000 30 16 99)
+train("${MINESWEEPER}" --seed 4 --player random --batch 200000 30 16 99)
+train("${MINESWEEPER}" --seed 5 --batch 4 1000 1000 150000)
+train("${BENCHMARK}" --max-side 1000 --min-time 0.01)
+
+if(CLANG)
+	if(NOT LLVM_PROFDATA)
+		message(FATAL_ERROR "llvm-profdata is needed to merge Clang profiles")
+	endif()
+	file(GLOB raw_profiles "${PGO_DIR}/*.profraw")
+	train("${LLVM_PROFDATA}" merge -output=${PGO_DIR}/default.profdata ${raw_profiles})
+endif()
@@ -0,0 +1,331 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef COMMAND_INPUT_H
+#define COMMAND_INPUT_H
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "minesweeper_game.h"
+
+// Exceptions
+class End_Of_Input {};			// Input ran out (or the player quit) before the game ended
+class Input_File_Error {};		// Command file couldn't be opened or read
+
+// Line Reader Class
+// Reads lines from a file descriptor through one buffer, so a file or pipe
+// of thousands of commands takes a handful of read() calls. Once the input
+// has ended, next_line() keeps returning false instead of waiting for more.
+class Line_Reader {
+private:
+	// Longer lines are cut short, so garbage without newlines can't use up memory
+	static constexpr size_t MAX_LINE_LENGTH = 4096;
+
+	int fd;
+	bool owns_fd;			// fd was opened by this reader and is closed by it
+	std::vector<char> buffer;
+	size_t start;			// Unread bytes are buffer[start, end)
+	size_t end;
+	bool at_end;			// read() returned 0 or failed
+
+public:
+	// Custom Constructor: Reads from file descriptor fd_in (left open)
+	explicit Line_Reader(int fd_in) : fd(fd_in), owns_fd(false), buffer(65536),
+		start(0), end(0), at_end(false) {}
+
+	// Custom Constructor: Reads the file at path
+	// Throws Input_File_Error if it can't be opened
+	explicit Line_Reader(const std::string& path) : Line_Reader(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+		if (fd < 0) throw Input_File_Error();
+		owns_fd = true;
+	}
+
+	~Line_Reader() {
+		if (owns_fd) close(fd);
+	}
+
+	Line_Reader(const Line_Reader&) = delete;
+	Line_Reader& operator=(const Line_Reader&) = delete;
+
+	// EFFECTS: Returns true if the input is a terminal (someone is typing)
+	bool is_terminal(void) const {
+		return isatty(fd) != 0;
+	}
+
+	// EFFECTS: Reads the next line into line, without its "\n" or "\r\n".
+	// Returns false once there are no more lines. The last line is returned
+	// even if it has no newline
+	bool next_line(std::string& line) {
+		line.clear();
+		while (1) {
+			for (size_t i = start; i < end; ++i) {
+				if (buffer[i] != '\n') continue;
+				append(line, start, i);
+				start = i + 1;
+				if (!line.empty() && line.back() == '\r') line.pop_back();
+				return true;
+			}
+			append(line, start, end);
+			start = end = 0;
+			if (at_end || !fill()) return !line.empty();
+		}
+	}
+
+private:
+	// EFFECTS: Appends buffer[from, to) to line, up to MAX_LINE_LENGTH characters
+	void append(std::string& line, size_t from, size_t to) const {
+		size_t room = MAX_LINE_LENGTH - std::min(line.size(), MAX_LINE_LENGTH);
+		line.append(&buffer[0] + from, std::min(to - from, room));
+	}
+
+	// EFFECTS: Reads more input into the empty buffer. Returns false at the
+	// end of the input, or if it can't be read
+	bool fill(void) {
+		while (1) {
+			ssize_t n = ::read(fd, &buffer[0], buffer.size());
+			if (n > 0) {
+				end = size_t(n);
+				return true;
+			}
+			if (n < 0 && errno == EINTR) continue;
+			at_end = true;
+			return false;
+		}
+	}
+};
+
+// A move read from the input
+struct Command {
+	Move_Action action;
+	int row;
+	int col;
+};
+
+// Command Reader Class
+// Reads moves as whole lines: an action, then the row and col of the tile.
+// "r 3 4" reveals row 3 col 4, "f 3 4" flags it, "q 3 4" question marks it,
+// and "c 3 4" chords it (the actions can also be spelled out, like "reveal").
+// A line of just "3 4" reveals. If a line stops after the action or the row,
+// the rest is asked for on the next lines, so "r", "3", and "4" on lines of
+// their own work too. Blank lines and lines starting with "#" are skipped.
+// A line that can't be read is thrown away with a message, and the end of the
+// input throws End_Of_Input, so bad input never leaves the reader stuck.
+// Prompts are only printed when the input is a terminal.
+class Command_Reader {
+private:
+	Line_Reader& reader;
+	bool prompts;
+	std::string line;	// Reused for every line
+
+public:
+	// Custom Constructor: Reads commands from reader_in
+	explicit Command_Reader(Line_Reader& reader_in) :
+		reader(reader_in), prompts(reader_in.is_terminal()) {}
+
+	// EFFECTS: Reads the next move. If reveal_only is true, only reveals are
+	// accepted. Throws End_Of_Input if the input ends first
+	Command read_move(bool reveal_only) {
+		Command command = { Move_Action::REVEAL, 0, 0 };
+		int parts = 0;		// 0: nothing yet, 1: action, 2: action and row, 3: done
+		while (1) {
+			prompt(parts, reveal_only);
+			if (!reader.next_line(line)) throw End_Of_Input();
+			if (!line.empty() && line[0] == '#') continue;
+			const char* next = line.c_str();
+			const char* error = nullptr;
+			std::string token;
+			while (!error && next_token(next, token)) {
+				int number = 0;
+				bool is_number = parse_int(token, number);
+				if (parts == 0) {
+					if (is_number) {
+						command.row = number;
+						parts = 2;
+					}
+					else if (parse_action(token, command.action)
+						&& (!reveal_only || command.action == Move_Action::REVEAL)) parts = 1;
+					else if (isdigit((unsigned char)token[0]) || token[0] == '-') error = "Invalid row or col";
+					else error = reveal_only ? "Only reveals can be made here" : "Invalid action";
+				}
+				else if (parts == 3) error = "Too many numbers";
+				else if (!is_number) error = "Invalid row or col";
+				else {
+					if (parts == 1) command.row = number;
+					else command.col = number;
+					++parts;
+				}
+			}
+			if (error) {
+				std::cout << error << std::endl;
+				parts = 0;
+			}
+			else if (parts == 3) return command;
+		}
+	}
+
+private:
+	// EFFECTS: Prints the prompt for what is still needed, if the input is
+	// a terminal
+	void prompt(int parts, bool reveal_only) const {
+		if (!prompts) return;
+		if (parts == 0 && reveal_only) std::cout << "Input row and col: ";
+		else if (parts == 0) {
+			std::cout << "Input move (r = reveal, f = flag, q = question mark, c = chord, "
+				<< "then row and col): ";
+		}
+		else if (parts == 1) std::cout << "Input row: ";
+		else std::cout << "Input col: ";
+		std::cout.flush();
+	}
+
+	// EFFECTS: Puts the next word of text (split by spaces and tabs) in token
+	// and moves text past it. Returns false if there are no more words
+	static bool next_token(const char*& text, std::string& token) {
+		while (*text == ' ' || *text == '\t') ++text;
+		if (!*text) return false;
+		const char* begin = text;
+		while (*text && *text != ' ' && *text != '\t') ++text;
+		token.assign(begin, text);
+		return true;
+	}
+
+	// EFFECTS: Sets number to token and returns true if token is a whole
+	// number that fits in an int
+	static bool parse_int(const std::string& token, int& number) {
+		errno = 0;
+		char* after = nullptr;
+		long value = std::strtol(token.c_str(), &after, 10);
+		if (after == token.c_str() || *after || errno == ERANGE) return false;
+		if (value < -2147483647L - 1 || value > 2147483647L) return false;
+		number = int(value);
+		return true;
+	}
+
+	// EFFECTS: Sets action to the one named by token and returns true, or
+	// returns false if token isn't an action
+	static bool parse_action(const std::string& token, Move_Action& action) {
+		if (token == "r" || token == "reveal") action = Move_Action::REVEAL;
+		else if (token == "f" || token == "flag") action = Move_Action::FLAG;
+		else if (token == "q" || token == "question") action = Move_Action::QUESTION;
+		else if (token == "c" || token == "chord") action = Move_Action::CHORD;
+		else return false;
+		return true;
+	}
+};
+
+// What a key press asks for when moves are picked with a cursor
+enum class Key {
+	UP,
+	DOWN,
+	LEFT,
+	RIGHT,
+	REVEAL,		// Space, Enter, or "r"
+	FLAG,		// "f"
+	QUESTION,	// "q"
+	CHORD,		// "c"
+	QUIT,		// Esc, Ctrl-C, or Ctrl-D
+	OTHER		// Anything else, ignored
+};
+
+// Key Reader Class
+// Reads single key presses from a terminal, which is kept in raw mode (no
+// echo, no waiting for Enter) until the Key_Reader is destroyed. Arrow keys
+// (and "h", "j", "k", "l") move the cursor. Waiting for a key sleeps in
+// poll(), so an idle player costs no CPU time.
+class Key_Reader {
+private:
+	// How long to wait for the rest of an arrow key after Esc
+	static constexpr int ESCAPE_WAIT_MS = 30;
+
+	int fd;
+	termios saved;		// Terminal settings to put back
+
+public:
+	// REQUIRES: fd_in is a terminal
+	// Custom Constructor: Switches the terminal at fd_in to raw mode
+	// Throws Input_File_Error if it can't be switched
+	explicit Key_Reader(int fd_in) : fd(fd_in) {
+		if (tcgetattr(fd, &saved) != 0) throw Input_File_Error();
+		termios raw = saved;
+		raw.c_iflag &= ~tcflag_t(ICRNL | IXON);
+		raw.c_lflag &= ~tcflag_t(ICANON | ECHO | ISIG | IEXTEN);
+		raw.c_cc[VMIN] = 1;
+		raw.c_cc[VTIME] = 0;
+		if (tcsetattr(fd, TCSAFLUSH, &raw) != 0) throw Input_File_Error();
+	}
+
+	~Key_Reader() {
+		tcsetattr(fd, TCSAFLUSH, &saved);
+	}
+
+	Key_Reader(const Key_Reader&) = delete;
+	Key_Reader& operator=(const Key_Reader&) = delete;
+
+	// EFFECTS: Waits for the next key press and returns what it asks for
+	// Throws End_Of_Input if the terminal is closed
+	Key next_key(void) {
+		unsigned char c = read_byte();
+		if (c == 27) {
+			// A lone Esc quits, Esc [ A to Esc [ D are the arrow keys
+			if (!wait_for_input(ESCAPE_WAIT_MS)) return Key::QUIT;
+			unsigned char bracket = read_byte();
+			if (bracket != '[' && bracket != 'O') return Key::OTHER;
+			unsigned char code = read_byte();
+			if (code == 'A') return Key::UP;
+			if (code == 'B') return Key::DOWN;
+			if (code == 'C') return Key::RIGHT;
+			if (code == 'D') return Key::LEFT;
+			return Key::OTHER;
+		}
+		if (c == 'k') return Key::UP;
+		if (c == 'j') return Key::DOWN;
+		if (c == 'h') return Key::LEFT;
+		if (c == 'l') return Key::RIGHT;
+		if (c == ' ' || c == '\r' || c == '\n' || c == 'r') return Key::REVEAL;
+		if (c == 'f') return Key::FLAG;
+		if (c == 'q') return Key::QUESTION;
+		if (c == 'c') return Key::CHORD;
+		if (c == 3 || c == 4) return Key::QUIT;
+		return Key::OTHER;
+	}
+
+private:
+	// EFFECTS: Returns true once there is input to read, or false if there
+	// is none after timeout_ms milliseconds (-1 waits for ever)
+	bool wait_for_input(int timeout_ms) const {
+		pollfd wanted = { fd, POLLIN, 0 };
+		while (1) {
+			int n = poll(&wanted, 1, timeout_ms);
+			if (n >= 0) return n > 0;
+			if (errno != EINTR) throw End_Of_Input();
+		}
+	}
+
+	// EFFECTS: Returns the next byte of input, waiting for it
+	// Throws End_Of_Input if the terminal is closed
+	unsigned char read_byte(void) const {
+		wait_for_input(-1);
+		while (1) {
+			unsigned char c = 0;
+			ssize_t n = ::read(fd, &c, 1);
+			if (n == 1) return c;
+			if (n < 0 && errno == EINTR) continue;
+			throw End_Of_Input();
+		}
+	}
+};
+
+#endif
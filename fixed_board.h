@@ -0,0 +1,531 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef FIXED_BOARD_H
+#define FIXED_BOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include "minesweeper_game.h"
+
+// Fixed Board Class
+// The same game as Minesweeper_Game on a board whose size and number of mines
+// are known when compiling, for the classic sizes most games are played on
+// (see the presets below). With the dimensions fixed, every loop over rows
+// and every index calculation uses constants, so the compiler can unroll them.
+// The board is kept as bitboards: one 32-bit word per row for each of mines,
+// revealed, flagged, question marked, and tiles with no nearby mines, with a
+// one bit border on every side like Minesweeper_Game's. The bitboards of an
+// expert board take 360 bytes, about six cache lines.
+// The same seed gives the same board as a Minesweeper_Game of the same size,
+// and every move does the same thing, so a game can be played on either and
+// the solver makes the same moves.
+template <int W, int H, int M>
+class Fixed_Board {
+	static_assert(W >= 2 && H >= 2, "A board needs at least 2 rows and 2 columns");
+	static_assert(W + 2 <= 32, "A row and its border must fit in 32 bits");
+	static_assert(M > 0 && M <= W * H, "A board needs between 1 mine and one mine per tile");
+	static_assert((H + 2) * (W + 2) <= 65536, "Tile indexes must fit in 16 bits");
+
+public:
+	// Tiles revealed by a move, as indexes into the board with its border
+	// (see Tile_at()), like Minesweeper_Game::last_revealed_tiles()
+	struct Tile_List {
+		const uint16_t* first;
+		const uint16_t* last;
+
+		const uint16_t* begin(void) const {
+			return first;
+		}
+
+		const uint16_t* end(void) const {
+			return last;
+		}
+
+		size_t size(void) const {
+			return size_t(last - first);
+		}
+
+		size_t operator[](size_t i) const {
+			return first[i];
+		}
+	};
+
+private:
+	// Bit c + 1 of a row is column c, bits 0 and W + 1 are the border. Rows 0
+	// and H + 1 are the border rows
+	typedef uint32_t Row;
+	static const size_t STRIDE = size_t(W) + 2;
+	static const size_t TOTAL_NUMBER_OF_TILES = size_t(W) * H;
+	static const Row INSIDE = ((Row(1) << W) - 1) << 1;	// Bits of the tiles on the board
+	static const Row WHOLE_ROW = Row(~Row(0) >> (30 - W));	// Board and border
+
+	Row mines[H + 2];
+	Row revealed[H + 2];	// Border tiles are always revealed
+	Row flagged[H + 2];
+	Row questioned[H + 2];
+	Row empty[H + 2];		// Tiles without a mine next to them
+	size_t unrevealed_safe_tiles;	// Tiles without a mine that are not yet revealed
+	size_t revealed_mines;	// Mines revealed, the game is lost if there are any
+	bool first_click_safe;	// Mines are placed on the first reveal, away from it
+	bool mines_are_placed;
+	uint64_t seed;			// Seed used to place the mines
+	std::mt19937_64 rng;	// One random number generator for the whole game
+	Move previous_move;		// Last move that was made, for move logs
+
+	// Tiles revealed by the most recent move, also used as the reveal's work queue
+	uint16_t revealed_tiles[TOTAL_NUMBER_OF_TILES];
+	size_t revealed_count;
+
+public:
+
+	// Default Constructor
+	Fixed_Board() : unrevealed_safe_tiles(TOTAL_NUMBER_OF_TILES - M), revealed_mines(0),
+		first_click_safe(false), mines_are_placed(false), seed(0),
+		previous_move{0, 0, Move_Action::REVEAL}, revealed_count(0) {
+		set_seed(Minesweeper_Game::random_seed());
+		make_board();
+	}
+
+	// Custom Constructor: For code that makes games from their dimensions,
+	// like Minesweeper_Game's. Throws Improper_Dimensions or
+	// Improper_Number_of_Mines unless they are the ones of this board
+	Fixed_Board(int width_in, int height_in, int number_of_mines_in) : Fixed_Board() {
+		if (width_in != W || height_in != H) throw Improper_Dimensions();
+		if (number_of_mines_in != M) throw Improper_Number_of_Mines();
+	}
+
+	// EFFECTS: Seeds the random number generator used to place mines
+	void set_seed(uint64_t seed_in) {
+		seed = seed_in;
+		rng.seed(seed_in);
+	}
+
+	// EFFECTS: Returns seed used to place the mines
+	uint64_t get_seed(void) const {
+		return seed;
+	}
+
+	// EFFECTS: Like Minesweeper_Game::set_first_click_safe()
+	void set_first_click_safe(bool on) {
+		first_click_safe = on;
+	}
+
+	// EFFECTS: Returns true if the first reveal can't hit a mine
+	bool is_first_click_safe(void) const {
+		return first_click_safe;
+	}
+
+	// EFFECTS: Returns true once the mines of the current game are on the board
+	bool mines_placed(void) const {
+		return mines_are_placed;
+	}
+
+	// EFFECTS: Clears the board and places the mines, ready for the first
+	// move (unless the first click is safe, then the first move places them)
+	void start_game(void) {
+		make_board();
+		if (!first_click_safe) place_mines_skipping(nullptr, 0);
+	}
+
+	// EFFECTS: Starts a new game with seed_in, like set_seed() then start_game()
+	// Note: Never allocates, the whole board is part of the object
+	void new_game(uint64_t seed_in) {
+		set_seed(seed_in);
+		start_game();
+	}
+
+	// EFFECTS: Reveals the tile at row and col, the same way as
+	// Minesweeper_Game::reveal()
+	Move_Result reveal(int row, int col) {
+		MINESWEEPER_TIME_STAGE(Stage::MOVE);
+		Move_Status status = check_move(row, col);
+		if (status != Move_Status::OK) return Move_Result{status, state(), 0};
+		if (bit(flagged, row + 1, col + 1)) return Move_Result{Move_Status::FLAGGED, state(), 0};
+		previous_move = Move{row, col, Move_Action::REVEAL};
+		if (!mines_are_placed) place_mines_avoiding(row, col);
+
+		revealed_count = 0;
+		if (bit(mines, row + 1, col + 1)) {
+			revealed[row + 1] |= Row(1) << (col + 1);
+			revealed_tiles[revealed_count++] = uint16_t(Tile_at(row, col));
+			++revealed_mines;
+			return Move_Result{Move_Status::OK, Game_State::LOST, 1};
+		}
+		queue_reveal(row + 1, col + 1);
+		size_t tiles_revealed = spread_reveal();
+		return Move_Result{Move_Status::OK, state(), tiles_revealed};
+	}
+
+	// EFFECTS: Flags or unflags the tile at row and col, the same way as
+	// Minesweeper_Game::flag()
+	Move_Result flag(int row, int col) {
+		return mark(row, col, flagged, questioned, Move_Action::FLAG);
+	}
+
+	// EFFECTS: Question marks the tile at row and col or takes the question
+	// mark away, the same way as Minesweeper_Game::question()
+	Move_Result question(int row, int col) {
+		return mark(row, col, questioned, flagged, Move_Action::QUESTION);
+	}
+
+	// EFFECTS: Chords the revealed tile at row and col, the same way as
+	// Minesweeper_Game::chord()
+	Move_Result chord(int row, int col) {
+		MINESWEEPER_TIME_STAGE(Stage::MOVE);
+		if (state() != Game_State::IN_PROGRESS) return Move_Result{Move_Status::GAME_OVER, state(), 0};
+		if (!valid_dimensions_chosen(row, col)) return Move_Result{Move_Status::OUT_OF_BOUNDS, state(), 0};
+		int r = row + 1;
+		int c = col + 1;
+		if (!bit(revealed, r, c)) return Move_Result{Move_Status::NOT_REVEALED, state(), 0};
+		if (count_around(flagged, r, c) != count_around(mines, r, c)) {
+			return Move_Result{Move_Status::WRONG_NUMBER_OF_FLAGS, state(), 0};
+		}
+		previous_move = Move{row, col, Move_Action::CHORD};
+
+		// Safe neighbours start the reveal, mines are only revealed after it
+		size_t mines_found[8];
+		size_t number_of_mines_found = 0;
+		revealed_count = 0;
+		for (int i = 0; i < 8; ++i) {
+			int nr = r + ROW_OFFSETS[i];
+			int nc = c + COLUMN_OFFSETS[i];
+			if (bit(revealed, nr, nc) || bit(flagged, nr, nc)) continue;
+			if (bit(mines, nr, nc)) mines_found[number_of_mines_found++] = size_t(nr) * STRIDE + nc;
+			else queue_reveal(nr, nc);
+		}
+		spread_reveal();
+		for (size_t i = 0; i < number_of_mines_found; ++i) {
+			size_t tile = mines_found[i];
+			revealed[tile / STRIDE] |= Row(1) << (tile % STRIDE);
+			revealed_tiles[revealed_count++] = uint16_t(tile);
+		}
+		revealed_mines += number_of_mines_found;
+		return Move_Result{Move_Status::OK, state(), revealed_count};
+	}
+
+	// EFFECTS: Returns state of the game
+	Game_State state(void) const {
+		if (revealed_mines > 0) return Game_State::LOST;
+		if (check_if_win()) return Game_State::WON;
+		return Game_State::IN_PROGRESS;
+	}
+
+	// EFFECTS: Returns true once every tile without a mine is revealed
+	bool check_if_win(void) const {
+		MINESWEEPER_COUNT(++game_counters().win_checks);
+		return unrevealed_safe_tiles == 0;
+	}
+
+	// EFFECTS: Returns number of tiles without a mine that are not yet revealed
+	size_t number_of_unrevealed_safe_tiles(void) const {
+		return unrevealed_safe_tiles;
+	}
+
+	// EFFECTS: Returns number of tiles on the board that have been revealed
+	size_t revealed_cells(void) const {
+		return TOTAL_NUMBER_OF_TILES - M - unrevealed_safe_tiles + revealed_mines;
+	}
+
+	// REQUIRES: A move has been made since start_game()
+	// EFFECTS: Returns the last move that was made (and not refused)
+	Move last_move(void) const {
+		return previous_move;
+	}
+
+	// EFFECTS: Returns the tiles revealed by the last move
+	Tile_List last_revealed_tiles(void) const {
+		return Tile_List{revealed_tiles, revealed_tiles + revealed_count};
+	}
+
+	// EFFECTS: Returns the same hash as Minesweeper_Game::board_digest() of
+	// a game with the same board
+	uint64_t board_digest(void) const {
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		for (int r = 1; r <= H; ++r) {
+			for (int c = 1; c <= W; ++c) {
+				unsigned tile = (bit(mines, r, c) ? 0x10 : 0) | (bit(revealed, r, c) ? 0x20 : 0)
+					| (bit(flagged, r, c) ? 0x40 : 0) | (bit(questioned, r, c) ? 0x80 : 0);
+				hash = (hash ^ tile) * 0x100000001B3ULL;
+			}
+		}
+		return hash;
+	}
+
+	// EFFECTS: Returns true if the tile at row and col has been revealed
+	bool is_revealed(int row, int col) const {
+		return bit(revealed, row + 1, col + 1);
+	}
+
+	// EFFECTS: Returns true if the tile at row and col is flagged
+	bool is_flagged(int row, int col) const {
+		return bit(flagged, row + 1, col + 1);
+	}
+
+	// EFFECTS: Returns what the player can see of the tile at row and col
+	Tile_State tile_state(int row, int col) const {
+		if (bit(revealed, row + 1, col + 1)) return Tile_State::REVEALED;
+		if (bit(flagged, row + 1, col + 1)) return Tile_State::FLAGGED;
+		if (bit(questioned, row + 1, col + 1)) return Tile_State::QUESTIONED;
+		return Tile_State::HIDDEN;
+	}
+
+	// EFFECTS: Returns number of mines next to the tile at row and col
+	// Note: Worked out from the three rows of mines around the tile, so
+	// there are no counts to keep up to date
+	int number_of_nearby_mines(int row, int col) const {
+		return count_around(mines, row + 1, col + 1);
+	}
+
+	// EFFECTS: Returns true if the tile at row and col has a mine
+	// Note: Players shouldn't look at this until the game is over
+	bool has_mine(int row, int col) const {
+		return bit(mines, row + 1, col + 1);
+	}
+
+	// EFFECTS: Returns character shown for the tile at row and col, the same
+	// way as Minesweeper_Game::tile_glyph()
+	char tile_glyph(int row, int col, bool game_over) const {
+		int r = row + 1;
+		int c = col + 1;
+		if (game_over) {
+			if (bit(mines, r, c)) return 'X';
+		}
+		else if (!bit(revealed, r, c)) {
+			if (bit(flagged, r, c)) return 'F';
+			return bit(questioned, r, c) ? 'Q' : '?';
+		}
+		int number_of_nearby_mines = count_around(mines, r, c);
+		if (number_of_nearby_mines == 0) return ' ';
+		return char('0' + number_of_nearby_mines);
+	}
+
+	// EFFECTS: Returns width of the board
+	int get_width(void) const {
+		return W;
+	}
+
+	// EFFECTS: Returns height of the board
+	int get_height(void) const {
+		return H;
+	}
+
+	// EFFECTS: Returns number of mines on the board
+	int get_number_of_mines(void) const {
+		return M;
+	}
+
+	// EFFECTS: Returns true if row and col are on the board
+	bool valid_dimensions_chosen(int row, int col) const {
+		return row >= 0 && row < H && col >= 0 && col < W;
+	}
+
+	// EFFECTS: Returns index of the tile at row and col on the board with its
+	// border, the same as Minesweeper_Game::Tile_at()
+	size_t Tile_at(int row, int col) const {
+		return size_t(row + 1) * STRIDE + size_t(col + 1);
+	}
+
+	// EFFECTS: Returns row index given index of tile (see Tile_at())
+	int row_index(size_t tile) const {
+		return int(tile / STRIDE) - 1;
+	}
+
+	// EFFECTS: Returns column index given index of tile (see Tile_at())
+	int column_index(size_t tile) const {
+		return int(tile % STRIDE) - 1;
+	}
+
+private:
+	// Neighbours in the same order as Minesweeper_Game's: N, NE, E, SE, S, SW, W, NW
+	static constexpr int ROW_OFFSETS[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+	static constexpr int COLUMN_OFFSETS[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+	// EFFECTS: Returns true if bit c of row r of plane is set
+	static bool bit(const Row* plane, int r, int c) {
+		return (plane[r] >> c) & 1;
+	}
+
+	// EFFECTS: Returns number of bits set in plane around row r and bit c,
+	// not counting the tile itself
+	static int count_around(const Row* plane, int r, int c) {
+		// Number of bits set in each 3 bit value
+		static const unsigned char BITS_SET[8] = { 0, 1, 1, 2, 1, 2, 2, 3 };
+		return BITS_SET[(plane[r - 1] >> (c - 1)) & 7] + BITS_SET[(plane[r] >> (c - 1)) & 5]
+			+ BITS_SET[(plane[r + 1] >> (c - 1)) & 7];
+	}
+
+	// EFFECTS: Returns row with every bit also copied to the bits beside it
+	static Row spread(Row row) {
+		return row | (row << 1) | (row >> 1);
+	}
+
+	// EFFECTS: Clears every tile and marks the border revealed
+	void make_board(void) {
+		MINESWEEPER_TIME_STAGE(Stage::MAKE_BOARD);
+		for (int r = 0; r < H + 2; ++r) {
+			mines[r] = 0;
+			revealed[r] = WHOLE_ROW & ~INSIDE;
+			flagged[r] = 0;
+			questioned[r] = 0;
+			empty[r] = 0;
+		}
+		revealed[0] = WHOLE_ROW;
+		revealed[H + 1] = WHOLE_ROW;
+		revealed_count = 0;
+		unrevealed_safe_tiles = TOTAL_NUMBER_OF_TILES - M;
+		revealed_mines = 0;
+		mines_are_placed = false;
+	}
+
+	// EFFECTS: Places mines like Minesweeper_Game::place_mines_avoiding()
+	void place_mines_avoiding(int row, int col) {
+		size_t excluded[9];
+		size_t count = 0;
+		for (int r = row - 1; r <= row + 1; ++r) {
+			for (int c = col - 1; c <= col + 1; ++c) {
+				if (valid_dimensions_chosen(r, c)) excluded[count++] = size_t(r) * W + c;
+			}
+		}
+		if (TOTAL_NUMBER_OF_TILES - count < size_t(M)) {
+			excluded[0] = size_t(row) * W + col;
+			count = TOTAL_NUMBER_OF_TILES - 1 < size_t(M) ? 0 : 1;
+		}
+		place_mines_skipping(excluded, count);
+	}
+
+	// REQUIRES: excluded holds count tile numbers in increasing order
+	// EFFECTS: Places the mines with Floyd's sampling, drawing the same random
+	// numbers as Minesweeper_Game::place_mines_skipping(), then marks the
+	// tiles with no mines around them
+	void place_mines_skipping(const size_t* excluded, size_t count) {
+		{
+			MINESWEEPER_TIME_STAGE(Stage::PLACE_MINES);
+			size_t tiles = TOTAL_NUMBER_OF_TILES - count;
+			for (size_t j = tiles - M; j < tiles; ++j) {
+				size_t x = skip_excluded(random_0_to_x(rng, j), excluded, count);
+				if (bit(mines, int(x / W) + 1, int(x % W) + 1)) x = skip_excluded(j, excluded, count);
+				mines[x / W + 1] |= Row(1) << (x % W + 1);
+			}
+		}
+		unrevealed_safe_tiles = TOTAL_NUMBER_OF_TILES - M;
+		mines_are_placed = true;
+		MINESWEEPER_TIME_STAGE(Stage::COUNT_NEARBY_MINES);
+		for (int r = 1; r <= H; ++r) {
+			Row nearby = spread(mines[r - 1]) | (mines[r] << 1) | (mines[r] >> 1) | spread(mines[r + 1]);
+			empty[r] = ~nearby & INSIDE;
+		}
+	}
+
+	// EFFECTS: Returns the number-th tile number (from 0) that isn't one of
+	// the count excluded tile numbers, which are in increasing order
+	static size_t skip_excluded(size_t number, const size_t* excluded, size_t count) {
+		for (size_t i = 0; i < count && excluded[i] <= number; ++i) ++number;
+		return number;
+	}
+
+	// EFFECTS: Returns OK if a move can be made on the tile at row and col
+	Move_Status check_move(int row, int col) const {
+		if (state() != Game_State::IN_PROGRESS) return Move_Status::GAME_OVER;
+		if (!valid_dimensions_chosen(row, col)) return Move_Status::OUT_OF_BOUNDS;
+		if (bit(revealed, row + 1, col + 1)) return Move_Status::ALREADY_REVEALED;
+		return Move_Status::OK;
+	}
+
+	// EFFECTS: Toggles the tile at row and col in plane and takes it out of
+	// other, then records the move as action
+	Move_Result mark(int row, int col, Row* plane, Row* other, Move_Action action) {
+		MINESWEEPER_TIME_STAGE(Stage::MOVE);
+		Move_Status status = check_move(row, col);
+		if (status != Move_Status::OK) return Move_Result{status, state(), 0};
+		Row tile_bit = Row(1) << (col + 1);
+		plane[row + 1] ^= tile_bit;
+		other[row + 1] &= ~tile_bit;
+		revealed_count = 0;
+		previous_move = Move{row, col, action};
+		return Move_Result{Move_Status::OK, state(), 0};
+	}
+
+	// REQUIRES: Tile at row r and bit c is on the board, not revealed, not
+	// flagged, and has no mine
+	// EFFECTS: Reveals the tile (removing any question mark) and queues it
+	void queue_reveal(int r, int c) {
+		Row tile_bit = Row(1) << c;
+		revealed[r] |= tile_bit;
+		questioned[r] &= ~tile_bit;
+		revealed_tiles[revealed_count++] = uint16_t(size_t(r) * STRIDE + c);
+	}
+
+	// EFFECTS: Spreads the reveal outward from every queued tile with no
+	// nearby mines in the same order as Minesweeper_Game::spread_reveal(),
+	// and updates the count of unrevealed safe tiles. Returns the number of
+	// tiles revealed including the ones already queued
+	size_t spread_reveal(void) {
+		MINESWEEPER_TIME_STAGE(Stage::REVEAL);
+		for (size_t next = 0; next < revealed_count; ++next) {
+			int r = int(revealed_tiles[next] / STRIDE);
+			int c = int(revealed_tiles[next] % STRIDE);
+			if (!bit(empty, r, c)) continue;
+			for (int i = 0; i < 8; ++i) {
+				int nr = r + ROW_OFFSETS[i];
+				int nc = c + COLUMN_OFFSETS[i];
+				if (((revealed[nr] | flagged[nr]) >> nc) & 1) continue;
+				queue_reveal(nr, nc);
+			}
+		}
+		unrevealed_safe_tiles -= revealed_count;
+		return revealed_count;
+	}
+};
+
+// The classic boards
+typedef Fixed_Board<9, 9, 10> Beginner_Board;
+typedef Fixed_Board<16, 16, 40> Intermediate_Board;
+typedef Fixed_Board<30, 16, 99> Expert_Board;
+
+// Size and number of mines of a classic board, picked by name with --preset
+struct Board_Preset {
+	const char* name;
+	int width;
+	int height;
+	int number_of_mines;
+};
+
+const Board_Preset BOARD_PRESETS[] = {
+	{ "beginner", 9, 9, 10 },
+	{ "intermediate", 16, 16, 40 },
+	{ "expert", 30, 16, 99 }
+};
+
+// EFFECTS: Returns the preset called name, or nullptr if there isn't one
+inline const Board_Preset* find_preset(const std::string& name) {
+	for (const Board_Preset& preset : BOARD_PRESETS) {
+		if (name == preset.name) return &preset;
+	}
+	return nullptr;
+}
+
+// Names a board type, so a function can be called with one
+template <class Board>
+struct Board_Type {
+	typedef Board type;
+};
+
+// EFFECTS: If width, height, and number_of_mines are one of the classic
+// boards, calls f with the Board_Type of its Fixed_Board and returns true.
+// Otherwise returns false
+template <class Function>
+bool with_fixed_board(int width, int height, int number_of_mines, Function&& f) {
+	if (width == 9 && height == 9 && number_of_mines == 10) f(Board_Type<Beginner_Board>());
+	else if (width == 16 && height == 16 && number_of_mines == 40) f(Board_Type<Intermediate_Board>());
+	else if (width == 30 && height == 16 && number_of_mines == 99) f(Board_Type<Expert_Board>());
+	else return false;
+	return true;
+}
+
+#endif
@@ -0,0 +1,618 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef GAME_SERVER_H
+#define GAME_SERVER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "minesweeper_game.h"
+#include "move_log.h"
+#include "server_protocol.h"
+
+// Totals of a Game_Server since it started
+struct Server_Statistics {
+	uint64_t connections = 0;	// Connections accepted
+	uint64_t games = 0;			// Games started
+	uint64_t moves = 0;			// Moves made (refused ones don't count)
+	uint64_t deltas = 0;		// DELTA messages sent, once for each client
+	uint64_t bytes_sent = 0;
+};
+
+// Game Server Class
+// Hosts games for clients on a local TCP or Unix socket (see
+// server_protocol.h), all on one thread with an epoll event loop. Any number
+// of clients can play or watch each game.
+// A move is made as soon as it arrives, and its DELTA (only the tiles that
+// changed) is built once and queued for everyone in the game. Queued
+// messages are written at the end of each turn of the loop, so all the
+// deltas a client gets from one turn go out in a single write.
+class Game_Server {
+private:
+	static const size_t MAX_CLIENT_MESSAGE = 64;		// Client messages are all small
+	static const size_t MAX_QUEUED_OUTPUT = 64 << 20;	// Clients this far behind are dropped
+	static const size_t READ_SIZE = 1 << 16;
+	static const int MAX_EVENTS = 256;
+	static const size_t MAX_SPARE_GAMES = 1024;
+
+	// One client
+	struct Connection {
+		int fd;
+		std::vector<unsigned char> in;	// Bytes received that aren't a whole message yet
+		std::vector<unsigned char> out;	// Bytes waiting to be written
+		size_t out_sent;		// Bytes at the start of out already written
+		bool queued;			// In to_flush
+		bool waiting_to_write;	// Socket was full, so EPOLLOUT is on
+		bool closing;			// Closed once its output has been tried
+		std::vector<uint32_t> games;	// Games it plays or watches
+	};
+
+	// Someone in a game
+	struct Member {
+		int fd;
+		bool player;	// Can make moves, otherwise only watches
+	};
+
+	struct Hosted_Game {
+		Minesweeper_Game game;
+		std::vector<Member> members;
+		uint32_t moves;
+
+		Hosted_Game(int width, int height, int number_of_mines) :
+			game(width, height, number_of_mines), moves(0) {}
+	};
+
+	int listen_fd;
+	int epoll_fd;
+	int stop_fd;			// eventfd written by stop()
+	bool tcp;
+	std::string socket_path;	// Unix socket removed when the server closes ("" for TCP)
+	size_t max_tiles;		// Largest board NEW_GAME can ask for
+	std::vector<std::unique_ptr<Connection>> connections;	// Indexed by file descriptor
+	size_t open_connections;
+	std::unordered_map<uint32_t, std::unique_ptr<Hosted_Game>> games;
+	std::vector<std::unique_ptr<Hosted_Game>> spare_games;	// Ended games, reused by NEW_GAME
+	uint32_t next_game_id;
+	std::vector<int> to_flush;	// Connections with output queued this turn
+	std::vector<unsigned char> message;	// Messages are built here before being queued
+	std::vector<unsigned char> read_buffer;
+	Server_Statistics stats;
+
+public:
+	// Custom Constructor: Listens on address (see parse_address()). Boards
+	// asked for with NEW_GAME can have at most max_tiles_in tiles
+	// Throws Server_Error if it can't listen there
+	explicit Game_Server(const std::string& address, size_t max_tiles_in = size_t(1) << 24) :
+		listen_fd(-1), epoll_fd(-1), stop_fd(-1), tcp(false), max_tiles(max_tiles_in),
+		open_connections(0), next_game_id(1), read_buffer(READ_SIZE) {
+		Server_Address server = parse_address(address);
+		tcp = server.tcp;
+		try {
+			listen_fd = socket(server.storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+			if (listen_fd < 0) throw Server_Error();
+			if (tcp) {
+				int on = 1;
+				setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+			}
+			else {
+				// Only a socket left behind by an earlier server is replaced
+				struct stat info;
+				if (stat(address.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) unlink(address.c_str());
+			}
+			if (bind(listen_fd, reinterpret_cast<const sockaddr*>(&server.storage), server.length) != 0) {
+				throw Server_Error();
+			}
+			if (!tcp) socket_path = address;
+			if (listen(listen_fd, SOMAXCONN) != 0) throw Server_Error();
+			epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+			stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (epoll_fd < 0 || stop_fd < 0) throw Server_Error();
+			watch(listen_fd, EPOLLIN, EPOLL_CTL_ADD);
+			watch(stop_fd, EPOLLIN, EPOLL_CTL_ADD);
+		}
+		catch (...) {
+			close_server_fds();
+			throw;
+		}
+	}
+
+	// Destructor: Disconnects every client and stops listening
+	~Game_Server() {
+		for (size_t fd = 0; fd < connections.size(); ++fd) {
+			if (connections[fd]) close(int(fd));
+		}
+		close_server_fds();
+	}
+
+	Game_Server(const Game_Server&) = delete;
+	Game_Server& operator=(const Game_Server&) = delete;
+
+	// EFFECTS: Serves clients until stop() is called. Throws Server_Error if
+	// the event loop fails
+	void run(void) {
+		epoll_event events[MAX_EVENTS];
+		bool running = true;
+		while (running) {
+			int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+			if (count < 0) {
+				if (errno == EINTR) continue;
+				throw Server_Error();
+			}
+			for (int i = 0; i < count; ++i) {
+				int fd = events[i].data.fd;
+				if (fd == listen_fd) accept_connections();
+				else if (fd == stop_fd) running = false;
+				else handle_events(fd, events[i].events);
+			}
+			flush_queued();
+		}
+		uint64_t value;
+		ssize_t n = read(stop_fd, &value, sizeof(value));
+		(void)n;
+	}
+
+	// EFFECTS: Makes run() return. Safe to call from another thread or from
+	// a signal handler
+	void stop(void) {
+		uint64_t one = 1;
+		ssize_t n = write(stop_fd, &one, sizeof(one));
+		(void)n;
+	}
+
+	// EFFECTS: Returns totals since the server started
+	const Server_Statistics& statistics(void) const {
+		return stats;
+	}
+
+	// EFFECTS: Returns number of games being played or watched
+	size_t number_of_games(void) const {
+		return games.size();
+	}
+
+	// EFFECTS: Returns number of clients connected
+	size_t number_of_connections(void) const {
+		return open_connections;
+	}
+
+private:
+	// EFFECTS: Adds fd to (or changes it in) the epoll set with events
+	void watch(int fd, uint32_t events, int operation) {
+		epoll_event event;
+		event.events = events;
+		event.data.fd = fd;
+		if (epoll_ctl(epoll_fd, operation, fd, &event) != 0) throw Server_Error();
+	}
+
+	// EFFECTS: Closes the listening socket, epoll, and stop_fd
+	void close_server_fds(void) {
+		if (listen_fd >= 0) close(listen_fd);
+		if (epoll_fd >= 0) close(epoll_fd);
+		if (stop_fd >= 0) close(stop_fd);
+		if (!socket_path.empty()) unlink(socket_path.c_str());
+		listen_fd = epoll_fd = stop_fd = -1;
+	}
+
+	// EFFECTS: Returns the connection on fd, or null if there isn't one
+	Connection* connection_on(int fd) {
+		if (fd < 0 || size_t(fd) >= connections.size()) return nullptr;
+		return connections[fd].get();
+	}
+
+	// EFFECTS: Accepts every connection waiting
+	// Note: If the process is out of file descriptors, the listening socket
+	// stays readable and the rest are tried again on the next turn of the loop
+	void accept_connections(void) {
+		while (1) {
+			int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd < 0) return;
+			if (tcp) set_no_delay(fd);
+			if (size_t(fd) >= connections.size()) connections.resize(size_t(fd) + 1);
+			connections[fd].reset(new Connection{fd, {}, {}, 0, false, false, false, {}});
+			watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+			++open_connections;
+			++stats.connections;
+		}
+	}
+
+	// EFFECTS: Handles epoll events on the connection on fd
+	void handle_events(int fd, uint32_t events) {
+		Connection* connection = connection_on(fd);
+		if (!connection) return;
+		if (events & EPOLLOUT) {
+			if (!write_output(*connection)) return;
+		}
+		if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) read_input(*connection);
+	}
+
+	// EFFECTS: Reads everything waiting on connection and handles every whole
+	// message received. Closes it if the client hung up or broke the protocol
+	void read_input(Connection& connection) {
+		if (connection.closing) return;
+		while (1) {
+			ssize_t n = read(connection.fd, read_buffer.data(), read_buffer.size());
+			if (n > 0) {
+				connection.in.insert(connection.in.end(), read_buffer.data(), read_buffer.data() + n);
+				if (size_t(n) < read_buffer.size()) break;
+			}
+			else if (n < 0 && errno == EINTR) continue;
+			else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+			else {
+				close_connection(connection.fd);
+				return;
+			}
+		}
+
+		size_t used = 0;
+		try {
+			while (!connection.closing) {
+				const unsigned char* data = connection.in.data() + used;
+				size_t size = complete_message_size(data, connection.in.size() - used, MAX_CLIENT_MESSAGE);
+				if (size == 0) break;
+				handle_message(connection, data, size);
+				used += size;
+			}
+		}
+		catch (const Bad_Message&) {
+			send_error(connection, Protocol_Error::BAD_MESSAGE, 0);
+			connection.closing = true;
+			return;
+		}
+		connection.in.erase(connection.in.begin(), connection.in.begin() + used);
+	}
+
+	// EFFECTS: Handles the whole message of size bytes at data from connection
+	// Throws Bad_Message if it isn't a message the server understands
+	void handle_message(Connection& connection, const unsigned char* data, size_t size) {
+		Message_Parser parser(data, size);
+		Message_Type type = message_type(data);
+		if (type == Message_Type::NEW_GAME) new_game(connection, parser);
+		else if (type == Message_Type::MOVE) make_move(connection, parser);
+		else if (type == Message_Type::WATCH) watch_game(connection, parser);
+		else if (type == Message_Type::LEAVE) leave_game(connection, parser);
+		else throw Bad_Message();
+	}
+
+	// EFFECTS: Starts the game asked for by a NEW_GAME message, with
+	// connection as its player
+	void new_game(Connection& connection, Message_Parser& parser) {
+		uint32_t width = parser.get_u32();
+		uint32_t height = parser.get_u32();
+		uint32_t number_of_mines = parser.get_u32();
+		uint64_t seed = parser.get_u64();
+		unsigned char flags = parser.get_u8();
+		if (!parser.at_end()) throw Bad_Message();
+		if (width > uint32_t(INT32_MAX) || height > uint32_t(INT32_MAX)
+			|| number_of_mines > uint32_t(INT32_MAX) || uint64_t(width) * height > max_tiles) {
+			send_error(connection, Protocol_Error::BAD_BOARD, 0);
+			return;
+		}
+		std::unique_ptr<Hosted_Game> hosted = take_spare_game(int(width), int(height), int(number_of_mines));
+		try {
+			if (!hosted) hosted.reset(new Hosted_Game(int(width), int(height), int(number_of_mines)));
+		}
+		catch (const Improper_Dimensions&) {}
+		catch (const Improper_Number_of_Mines&) {}
+		if (!hosted) {
+			send_error(connection, Protocol_Error::BAD_BOARD, 0);
+			return;
+		}
+		Minesweeper_Game& game = hosted->game;
+		game.set_first_click_safe(flags & NEW_GAME_FIRST_CLICK_SAFE);
+		game.new_game(seed != 0 ? seed : Minesweeper_Game::random_seed());
+
+		uint32_t id = next_game_id++;
+		if (next_game_id == 0) next_game_id = 1;
+		hosted->members.push_back(Member{connection.fd, true});
+		connection.games.push_back(id);
+		send_game_info(connection, id, game);
+		games[id] = std::move(hosted);
+		++stats.games;
+	}
+
+	// EFFECTS: Makes the move in a MOVE message and sends the tiles that
+	// changed to everyone in the game (or why it was refused to connection)
+	void make_move(Connection& connection, Message_Parser& parser) {
+		uint32_t id = parser.get_u32();
+		unsigned char action = parser.get_u8();
+		uint32_t row = parser.get_u32();
+		uint32_t col = parser.get_u32();
+		if (!parser.at_end() || action > (unsigned char)Move_Action::CHORD) throw Bad_Message();
+		Hosted_Game* hosted = game_with_id(id);
+		if (!hosted) {
+			send_error(connection, Protocol_Error::NO_SUCH_GAME, id);
+			return;
+		}
+		Member* member = member_of(*hosted, connection.fd);
+		if (!member || !member->player) {
+			send_error(connection, Protocol_Error::NOT_A_PLAYER, id);
+			return;
+		}
+
+		Minesweeper_Game& game = hosted->game;
+		Move move{int(std::min(row, uint32_t(INT32_MAX))), int(std::min(col, uint32_t(INT32_MAX))),
+			Move_Action(action)};
+		Move_Result result = apply_move(game, move);
+		message.clear();
+		if (result.status != Move_Status::OK) {
+			build_delta(id, *hosted, result.status, nullptr, 0);
+			queue(connection, message);
+			++stats.deltas;
+			return;
+		}
+		++hosted->moves;
+		++stats.moves;
+		if (move.action == Move_Action::REVEAL || move.action == Move_Action::CHORD) {
+			const std::vector<size_t>& revealed = game.last_revealed_tiles();
+			build_delta(id, *hosted, Move_Status::OK, revealed.data(), revealed.size());
+		}
+		else {
+			size_t tile = game.Tile_at(move.row, move.col);
+			build_delta(id, *hosted, Move_Status::OK, &tile, 1);
+		}
+		for (const Member& other : hosted->members) {
+			Connection* recipient = connection_on(other.fd);
+			if (recipient) queue(*recipient, message);
+		}
+		stats.deltas += hosted->members.size();
+	}
+
+	// EFFECTS: Adds connection to the game in a WATCH message and sends it
+	// the game so far
+	void watch_game(Connection& connection, Message_Parser& parser) {
+		uint32_t id = parser.get_u32();
+		unsigned char flags = parser.get_u8();
+		if (!parser.at_end()) throw Bad_Message();
+		Hosted_Game* hosted = game_with_id(id);
+		if (!hosted) {
+			send_error(connection, Protocol_Error::NO_SUCH_GAME, id);
+			return;
+		}
+		Member* member = member_of(*hosted, connection.fd);
+		if (member) member->player = member->player || (flags & WATCH_AS_PLAYER);
+		else {
+			hosted->members.push_back(Member{connection.fd, bool(flags & WATCH_AS_PLAYER)});
+			connection.games.push_back(id);
+		}
+		send_game_info(connection, id, hosted->game);
+		message.clear();
+		build_full_delta(id, *hosted);
+		queue(connection, message);
+		++stats.deltas;
+	}
+
+	// EFFECTS: Takes connection out of the game in a LEAVE message
+	void leave_game(Connection& connection, Message_Parser& parser) {
+		uint32_t id = parser.get_u32();
+		if (!parser.at_end()) throw Bad_Message();
+		if (!remove_member(id, connection.fd)) {
+			send_error(connection, Protocol_Error::NO_SUCH_GAME, id);
+			return;
+		}
+		std::vector<uint32_t>& ids = connection.games;
+		ids.erase(std::find(ids.begin(), ids.end(), id));
+	}
+
+	// EFFECTS: Returns the game with id, or null if there isn't one
+	Hosted_Game* game_with_id(uint32_t id) {
+		auto found = games.find(id);
+		return found == games.end() ? nullptr : found->second.get();
+	}
+
+	// EFFECTS: Returns the member of hosted on fd, or null if fd isn't in it
+	static Member* member_of(Hosted_Game& hosted, int fd) {
+		for (Member& member : hosted.members) {
+			if (member.fd == fd) return &member;
+		}
+		return nullptr;
+	}
+
+	// EFFECTS: Takes fd out of the game with id, and ends the game if nobody
+	// is left in it. Returns false if fd wasn't in the game
+	bool remove_member(uint32_t id, int fd) {
+		Hosted_Game* hosted = game_with_id(id);
+		if (!hosted) return false;
+		Member* member = member_of(*hosted, fd);
+		if (!member) return false;
+		*member = hosted->members.back();
+		hosted->members.pop_back();
+		if (hosted->members.empty()) end_game(id);
+		return true;
+	}
+
+	// EFFECTS: Removes the game with id, keeping it as a spare if there's room
+	void end_game(uint32_t id) {
+		auto found = games.find(id);
+		if (spare_games.size() < MAX_SPARE_GAMES) spare_games.push_back(std::move(found->second));
+		games.erase(found);
+	}
+
+	// EFFECTS: Returns a spare game with the same board, or null if there
+	// isn't one. Its board and members list keep their memory, so starting
+	// it again makes no allocations (see Minesweeper_Game::new_game())
+	std::unique_ptr<Hosted_Game> take_spare_game(int width, int height, int number_of_mines) {
+		for (size_t i = spare_games.size(); i-- > 0;) {
+			const Minesweeper_Game& game = spare_games[i]->game;
+			if (game.get_width() != width || game.get_height() != height
+				|| game.get_number_of_mines() != number_of_mines) continue;
+			std::unique_ptr<Hosted_Game> hosted = std::move(spare_games[i]);
+			spare_games[i] = std::move(spare_games.back());
+			spare_games.pop_back();
+			hosted->moves = 0;
+			return hosted;
+		}
+		return nullptr;
+	}
+
+	// EFFECTS: Appends a DELTA for the game with id to message. Its tiles are
+	// the count tiles at tiles (indexes into the board, see
+	// Minesweeper_Game::Tile_at()), then every mine once the game is over
+	void build_delta(uint32_t id, const Hosted_Game& hosted, Move_Status status,
+		const size_t* tiles, size_t count) {
+		const Minesweeper_Game& game = hosted.game;
+		Message_Builder delta = start_delta(id, hosted, status);
+		size_t count_position = delta.position();
+		delta.put_u32(0);
+		uint32_t cells = 0;
+		for (size_t i = 0; i < count; ++i) {
+			put_cell(delta, game, game.row_index(tiles[i]), game.column_index(tiles[i]));
+			++cells;
+		}
+		if (status == Move_Status::OK && game.state() != Game_State::IN_PROGRESS) {
+			// Mines revealed by this move are already in tiles
+			for (int row = 0; row < game.get_height(); ++row) {
+				for (int col = 0; col < game.get_width(); ++col) {
+					if (!game.has_mine(row, col) || game.is_revealed(row, col)) continue;
+					put_cell(delta, game, row, col);
+					++cells;
+				}
+			}
+		}
+		delta.patch_u32(count_position, cells);
+		delta.finish();
+	}
+
+	// EFFECTS: Appends a DELTA with every tile of the game with id that
+	// isn't hidden to message
+	void build_full_delta(uint32_t id, const Hosted_Game& hosted) {
+		const Minesweeper_Game& game = hosted.game;
+		Message_Builder delta = start_delta(id, hosted, Move_Status::OK);
+		size_t count_position = delta.position();
+		delta.put_u32(0);
+		uint32_t cells = 0;
+		for (int row = 0; row < game.get_height(); ++row) {
+			for (int col = 0; col < game.get_width(); ++col) {
+				if (cell_value(game, row, col) == CELL_HIDDEN) continue;
+				put_cell(delta, game, row, col);
+				++cells;
+			}
+		}
+		delta.patch_u32(count_position, cells);
+		delta.finish();
+	}
+
+	// EFFECTS: Starts a DELTA in message with everything before the tiles
+	// but their count
+	Message_Builder start_delta(uint32_t id, const Hosted_Game& hosted, Move_Status status) {
+		Message_Builder delta(message, Message_Type::DELTA);
+		delta.put_u32(id);
+		delta.put_u32(hosted.moves);
+		delta.put_u8((unsigned char)status);
+		delta.put_u8((unsigned char)hosted.game.state());
+		return delta;
+	}
+
+	// EFFECTS: Appends the tile at row and col to a DELTA
+	static void put_cell(Message_Builder& delta, const Minesweeper_Game& game, int row, int col) {
+		delta.put_varint(game.tile_number(row, col));
+		delta.put_u8(cell_value(game, row, col));
+	}
+
+	// EFFECTS: Queues a GAME_INFO for the game with id to connection
+	void send_game_info(Connection& connection, uint32_t id, const Minesweeper_Game& game) {
+		message.clear();
+		Message_Builder info(message, Message_Type::GAME_INFO);
+		info.put_u32(id);
+		info.put_u32(uint32_t(game.get_width()));
+		info.put_u32(uint32_t(game.get_height()));
+		info.put_u32(uint32_t(game.get_number_of_mines()));
+		info.put_u64(game.get_seed());
+		info.finish();
+		queue(connection, message);
+	}
+
+	// EFFECTS: Queues an ERROR to connection
+	void send_error(Connection& connection, Protocol_Error error, uint32_t id) {
+		message.clear();
+		Message_Builder reply(message, Message_Type::ERROR);
+		reply.put_u8((unsigned char)error);
+		reply.put_u32(id);
+		reply.finish();
+		queue(connection, message);
+	}
+
+	// EFFECTS: Adds bytes to the output of connection, to be written at the
+	// end of this turn of the loop. A client that has fallen too far behind
+	// is closed instead
+	void queue(Connection& connection, const std::vector<unsigned char>& bytes) {
+		if (connection.closing) return;
+		connection.out.insert(connection.out.end(), bytes.begin(), bytes.end());
+		if (connection.out.size() - connection.out_sent > MAX_QUEUED_OUTPUT) connection.closing = true;
+		if (!connection.queued) {
+			connection.queued = true;
+			to_flush.push_back(connection.fd);
+		}
+	}
+
+	// EFFECTS: Writes the output queued this turn
+	void flush_queued(void) {
+		for (int fd : to_flush) {
+			Connection* connection = connection_on(fd);
+			if (!connection || !connection->queued) continue;
+			connection->queued = false;
+			write_output(*connection);
+		}
+		to_flush.clear();
+	}
+
+	// EFFECTS: Writes as much of the output of connection as the socket
+	// takes, and waits for EPOLLOUT if some is left. Closes connection if
+	// writing fails or it was closing. Returns false if it was closed
+	bool write_output(Connection& connection) {
+		while (connection.out_sent < connection.out.size()) {
+			ssize_t n = send(connection.fd, connection.out.data() + connection.out_sent,
+				connection.out.size() - connection.out_sent, MSG_NOSIGNAL);
+			if (n > 0) {
+				connection.out_sent += size_t(n);
+				stats.bytes_sent += uint64_t(n);
+			}
+			else if (n < 0 && errno == EINTR) continue;
+			else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+			else {
+				close_connection(connection.fd);
+				return false;
+			}
+		}
+		if (connection.closing) {
+			close_connection(connection.fd);
+			return false;
+		}
+		bool left_over = connection.out_sent < connection.out.size();
+		if (!left_over || connection.out_sent > connection.out.size() / 2) {
+			// Drop what has been written, so the buffer doesn't keep growing
+			connection.out.erase(connection.out.begin(), connection.out.begin() + connection.out_sent);
+			connection.out_sent = 0;
+		}
+		if (left_over != connection.waiting_to_write) {
+			watch(connection.fd, left_over ? EPOLLIN | EPOLLOUT : EPOLLIN, EPOLL_CTL_MOD);
+			connection.waiting_to_write = left_over;
+		}
+		return true;
+	}
+
+	// EFFECTS: Takes the client on fd out of all its games and disconnects it
+	void close_connection(int fd) {
+		Connection* connection = connection_on(fd);
+		if (!connection) return;
+		for (uint32_t id : connection->games) remove_member(id, fd);
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+		close(fd);
+		connections[fd].reset();
+		--open_connections;
+	}
+};
+
+#endif
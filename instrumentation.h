@@ -0,0 +1,216 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Instrumentation is only built in when MINESWEEPER_INSTRUMENT is defined
+// (cmake -DMINESWEEPER_INSTRUMENT=ON). Otherwise the macros below expand to
+// nothing, so the hot paths are exactly as fast as without them.
+//   MINESWEEPER_TIME_STAGE(stage)  times the rest of the enclosing scope
+//   MINESWEEPER_COUNT(statements)  runs statements, usually to update counters
+#ifdef MINESWEEPER_INSTRUMENT
+#define MINESWEEPER_CONCAT_HELPER(a, b) a##b
+#define MINESWEEPER_CONCAT(a, b) MINESWEEPER_CONCAT_HELPER(a, b)
+#define MINESWEEPER_TIME_STAGE(stage) \
+	Scoped_Stage_Timer MINESWEEPER_CONCAT(stage_timer_, __LINE__)(stage)
+#define MINESWEEPER_COUNT(...) __VA_ARGS__
+const bool INSTRUMENTATION_ENABLED = true;
+#else
+#define MINESWEEPER_TIME_STAGE(stage)
+#define MINESWEEPER_COUNT(...)
+const bool INSTRUMENTATION_ENABLED = false;
+#endif
+
+// Parts of the game that are timed
+// Note: Stages can nest. A move includes the reveal it makes, and placing
+// the mines on the first move includes counting nearby mines
+enum class Stage {
+	MAKE_BOARD,			// Minesweeper_Game::make_board()
+	PLACE_MINES,		// Picking the tiles that get mines (or making a chunk
+						// of a Chunked_Minesweeper_Game)
+	COUNT_NEARBY_MINES,	// Minesweeper_Game::count_nearby_mines()
+	REVEAL,				// One pass of revealing outward from the tiles picked
+	MOVE,				// reveal(), flag(), question(), or chord()
+	RENDER,				// Board_Renderer::draw()
+	NUMBER_OF_STAGES
+};
+
+const int NUMBER_OF_STAGES = int(Stage::NUMBER_OF_STAGES);
+
+// EFFECTS: Returns the name of stage used in stats
+inline const char* stage_name(Stage stage) {
+	static const char* const names[NUMBER_OF_STAGES] = {
+		"make_board", "place_mines", "count_nearby_mines", "reveal", "move", "render"
+	};
+	return names[int(stage)];
+}
+
+// Timing of one stage
+struct Stage_Stats {
+	uint64_t calls = 0;
+	uint64_t nanoseconds = 0;
+	uint64_t max_nanoseconds = 0;	// Longest single call
+
+	// EFFECTS: Adds one call that took nanoseconds_in
+	void add_call(uint64_t nanoseconds_in) {
+		++calls;
+		nanoseconds += nanoseconds_in;
+		max_nanoseconds = std::max(max_nanoseconds, nanoseconds_in);
+	}
+};
+
+// Performance Counters Class
+// Everything the instrumentation measures. The engine and renderer update
+// the game_counters() of their thread, and each game's counters are added to
+// total_counters() when it ends (see finish_game_counters())
+struct Performance_Counters {
+	Stage_Stats stages[NUMBER_OF_STAGES];
+	uint64_t reveal_passes = 0;		// Calls to spread the reveal
+	uint64_t cells_visited = 0;		// Tiles looked at while revealing
+	uint64_t max_cells_per_reveal = 0;
+	uint64_t max_queue_depth = 0;	// Most tiles waiting to be spread from at once
+	uint64_t win_checks = 0;
+	uint64_t frames = 0;
+	uint64_t bytes_written = 0;		// Bytes of all frames
+	uint64_t max_frame_bytes = 0;
+	uint64_t games = 0;				// Games added to these counters
+
+	// EFFECTS: Returns timing of stage
+	Stage_Stats& stage(Stage stage_in) {
+		return stages[int(stage_in)];
+	}
+
+	// EFFECTS: Returns timing of stage
+	const Stage_Stats& stage(Stage stage_in) const {
+		return stages[int(stage_in)];
+	}
+
+	// EFFECTS: Adds one pass of the reveal that looked at cells tiles and
+	// had at most queue_depth tiles waiting
+	void add_reveal_pass(uint64_t cells, uint64_t queue_depth) {
+		++reveal_passes;
+		cells_visited += cells;
+		max_cells_per_reveal = std::max(max_cells_per_reveal, cells);
+		max_queue_depth = std::max(max_queue_depth, queue_depth);
+	}
+
+	// EFFECTS: Adds a frame of bytes bytes
+	void add_frame(uint64_t bytes) {
+		++frames;
+		bytes_written += bytes;
+		max_frame_bytes = std::max(max_frame_bytes, bytes);
+	}
+
+	// EFFECTS: Adds other to these counters
+	void add(const Performance_Counters& other) {
+		for (int i = 0; i < NUMBER_OF_STAGES; ++i) {
+			stages[i].calls += other.stages[i].calls;
+			stages[i].nanoseconds += other.stages[i].nanoseconds;
+			stages[i].max_nanoseconds = std::max(stages[i].max_nanoseconds, other.stages[i].max_nanoseconds);
+		}
+		reveal_passes += other.reveal_passes;
+		cells_visited += other.cells_visited;
+		max_cells_per_reveal = std::max(max_cells_per_reveal, other.max_cells_per_reveal);
+		max_queue_depth = std::max(max_queue_depth, other.max_queue_depth);
+		win_checks += other.win_checks;
+		frames += other.frames;
+		bytes_written += other.bytes_written;
+		max_frame_bytes = std::max(max_frame_bytes, other.max_frame_bytes);
+		games += other.games;
+	}
+
+	// EFFECTS: Prints the counters on one line, times in milliseconds
+	void print_summary(std::ostream& os) const {
+		os << "Stats:";
+		for (int i = 0; i < NUMBER_OF_STAGES; ++i) {
+			if (stages[i].calls == 0) continue;
+			os << " " << stage_name(Stage(i)) << " " << stages[i].calls << "x "
+				<< stages[i].nanoseconds / 1e6 << " ms (max " << stages[i].max_nanoseconds / 1e6 << " ms),";
+		}
+		os << " cells visited " << cells_visited << " (max " << max_cells_per_reveal
+			<< " per reveal), max queue depth " << max_queue_depth
+			<< ", win checks " << win_checks
+			<< ", frames " << frames << " (" << bytes_written << " bytes, max "
+			<< max_frame_bytes << ")" << std::endl;
+	}
+
+	// EFFECTS: Prints the counters as a JSON object
+	void print_json(std::ostream& os) const {
+		os << "{\n  \"games\": " << games << ",\n  \"stages\": [";
+		for (int i = 0; i < NUMBER_OF_STAGES; ++i) {
+			os << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << stage_name(Stage(i))
+				<< "\", \"calls\": " << stages[i].calls
+				<< ", \"total_ns\": " << stages[i].nanoseconds
+				<< ", \"max_ns\": " << stages[i].max_nanoseconds << "}";
+		}
+		os << "\n  ],\n"
+			<< "  \"reveal_passes\": " << reveal_passes << ",\n"
+			<< "  \"cells_visited\": " << cells_visited << ",\n"
+			<< "  \"max_cells_per_reveal\": " << max_cells_per_reveal << ",\n"
+			<< "  \"max_queue_depth\": " << max_queue_depth << ",\n"
+			<< "  \"win_checks\": " << win_checks << ",\n"
+			<< "  \"frames\": " << frames << ",\n"
+			<< "  \"bytes_written\": " << bytes_written << ",\n"
+			<< "  \"max_frame_bytes\": " << max_frame_bytes << "\n"
+			<< "}" << std::endl;
+	}
+};
+
+// EFFECTS: Returns the counters of the game being played on this thread
+// Note: Counters are per thread, so games played on other threads (batches,
+// no-guess searches) don't show up here
+inline Performance_Counters& game_counters(void) {
+	static thread_local Performance_Counters counters;
+	return counters;
+}
+
+// EFFECTS: Returns the counters of every game finished on this thread
+inline Performance_Counters& total_counters(void) {
+	static thread_local Performance_Counters counters;
+	return counters;
+}
+
+// EFFECTS: Adds the counters of the game that just ended to the totals and
+// clears them for the next game
+inline void finish_game_counters(void) {
+	Performance_Counters& game = game_counters();
+	++game.games;
+	total_counters().add(game);
+	game = Performance_Counters();
+}
+
+// Scoped Stage Timer Class
+// Adds the time from its construction to its destruction to a stage of
+// game_counters(). Use MINESWEEPER_TIME_STAGE() rather than this directly
+class Scoped_Stage_Timer {
+private:
+	Stage stage;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	// Custom Constructor: Starts timing stage
+	explicit Scoped_Stage_Timer(Stage stage_in) :
+		stage(stage_in), start(std::chrono::steady_clock::now()) {}
+
+	// Destructor: Stops timing
+	~Scoped_Stage_Timer() {
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		game_counters().stage(stage).add_call(uint64_t(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+	}
+
+	Scoped_Stage_Timer(const Scoped_Stage_Timer&) = delete;
+	Scoped_Stage_Timer& operator=(const Scoped_Stage_Timer&) = delete;
+};
+
+#endif
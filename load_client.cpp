@@ -0,0 +1,371 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+// Load test for Game_Server. Start a server ("minesweeper --serve ADDRESS"),
+// then point this at it. Every player has its own connection and plays
+// random games back to back, one move at a time, and each player's games are
+// watched by spectators on their own connections. Prints how many moves per
+// second the server made, how long each move took to come back, and checks
+// every spectator ended up with the same board as the player.
+//
+// Options:
+//   --connect ADDRESS   Server to test: a port on 127.0.0.1 or a Unix socket path
+//   --clients N         Number of players (default 1000)
+//   --spectators N      Spectators watching each player's games (default 1)
+//   --seconds S         How long to keep starting moves (default 5)
+//   --seed N            Boards are made from this seed (default 1)
+//   --board W H M       Board to play (default 30 16 99)
+
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "minesweeper_game.h"
+#include "server_protocol.h"
+
+using namespace std;
+
+// One connection to the server, either a player or a spectator
+struct Client {
+	int fd = -1;
+	bool player = false;
+	Client* watched = nullptr;		// Player whose games a spectator watches
+	vector<Client*> spectators;		// Spectators of a player's games
+	vector<unsigned char> in;		// Bytes received that aren't a whole message yet
+	uint32_t game = 0;				// Game being played or watched
+	vector<unsigned char> cells;	// Board as the client sees it
+	size_t hidden = 0;				// Cells still hidden
+	mt19937_64 rng;
+	chrono::steady_clock::time_point sent;	// When the last move was sent
+	bool waiting = false;			// Waiting for the server to answer
+	uint32_t finished_game = 0;		// Last game that ended, and how its board
+	vector<unsigned char> finished_cells;	// looked, to compare with the others
+};
+
+// Load Client Class
+// Runs every client on one epoll loop and keeps the totals
+class Load_Client {
+private:
+	string address;
+	int width;
+	int height;
+	int number_of_mines;
+	uint64_t seed;
+	vector<unique_ptr<Client>> clients;
+	int epoll_fd;
+	chrono::steady_clock::time_point deadline;
+	uint64_t games_started = 0;
+
+public:
+	// Totals
+	uint64_t games_finished = 0;
+	uint64_t games_won = 0;
+	uint64_t moves = 0;
+	uint64_t spectator_deltas = 0;
+	uint64_t boards_checked = 0;
+	uint64_t mismatches = 0;
+	uint64_t errors = 0;
+	vector<uint32_t> latencies;	// Nanoseconds from sending each move to its DELTA
+
+	// Custom Constructor: Connects players with spectators each to the
+	// server at address_in. Throws Server_Error if it can't
+	Load_Client(const string& address_in, int players, int spectators, int width_in,
+		int height_in, int number_of_mines_in, uint64_t seed_in) :
+		address(address_in), width(width_in), height(height_in),
+		number_of_mines(number_of_mines_in), seed(seed_in) {
+		epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		if (epoll_fd < 0) throw Server_Error();
+		for (int i = 0; i < players; ++i) {
+			Client* player = add_client();
+			player->player = true;
+			player->rng.seed(mix_64(seed + i));
+			for (int j = 0; j < spectators; ++j) {
+				Client* spectator = add_client();
+				spectator->watched = player;
+				player->spectators.push_back(spectator);
+			}
+		}
+	}
+
+	// Destructor
+	~Load_Client() {
+		for (auto& client : clients) close(client->fd);
+		close(epoll_fd);
+	}
+
+	Load_Client(const Load_Client&) = delete;
+	Load_Client& operator=(const Load_Client&) = delete;
+
+	// EFFECTS: Plays for seconds seconds, then waits for the last moves and
+	// deltas to come back
+	void run(double seconds) {
+		deadline = chrono::steady_clock::now()
+			+ chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+		for (auto& client : clients) {
+			if (client->player) start_game(*client);
+		}
+		epoll_event events[256];
+		while (1) {
+			bool playing = false;
+			for (auto& client : clients) playing = playing || client->waiting;
+			// Once every player is done, wait a little for the spectators
+			int count = epoll_wait(epoll_fd, events, 256, playing ? 1000 : 200);
+			if (count <= 0 && !playing) break;
+			for (int i = 0; i < count; ++i) {
+				read_messages(*static_cast<Client*>(events[i].data.ptr));
+			}
+		}
+	}
+
+private:
+	// EFFECTS: Connects a new client to the server
+	Client* add_client(void) {
+		clients.emplace_back(new Client);
+		Client* client = clients.back().get();
+		client->fd = connect_to_server(address);
+		epoll_event event;
+		event.events = EPOLLIN;
+		event.data.ptr = client;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client->fd, &event) != 0) throw Server_Error();
+		return client;
+	}
+
+	// EFFECTS: Sends the message in bytes to client
+	static void send_message(Client& client, const vector<unsigned char>& bytes) {
+		size_t sent = 0;
+		while (sent < bytes.size()) {
+			ssize_t n = write(client.fd, bytes.data() + sent, bytes.size() - sent);
+			if (n <= 0) throw Server_Error();
+			sent += size_t(n);
+		}
+	}
+
+	// EFFECTS: Asks for a new game for player
+	void start_game(Client& player) {
+		vector<unsigned char> bytes;
+		Message_Builder message(bytes, Message_Type::NEW_GAME);
+		message.put_u32(uint32_t(width));
+		message.put_u32(uint32_t(height));
+		message.put_u32(uint32_t(number_of_mines));
+		message.put_u64(mix_64(seed ^ mix_64(++games_started)) | 1);
+		message.put_u8(NEW_GAME_FIRST_CLICK_SAFE);
+		message.finish();
+		send_message(player, bytes);
+		player.waiting = true;
+	}
+
+	// EFFECTS: Sends a game id message of type (WATCH or LEAVE) to client
+	static void send_game_message(Client& client, Message_Type type, uint32_t game) {
+		vector<unsigned char> bytes;
+		Message_Builder message(bytes, type);
+		message.put_u32(game);
+		if (type == Message_Type::WATCH) message.put_u8(0);
+		message.finish();
+		send_message(client, bytes);
+	}
+
+	// EFFECTS: Reveals a random hidden cell of player's game
+	void send_move(Client& player) {
+		size_t cell;
+		do {
+			cell = size_t(random_0_to_x(player.rng, player.cells.size() - 1));
+		} while (player.cells[cell] != CELL_HIDDEN);
+		vector<unsigned char> bytes;
+		Message_Builder message(bytes, Message_Type::MOVE);
+		message.put_u32(player.game);
+		message.put_u8((unsigned char)Move_Action::REVEAL);
+		message.put_u32(uint32_t(cell / width));
+		message.put_u32(uint32_t(cell % width));
+		message.finish();
+		player.sent = chrono::steady_clock::now();
+		send_message(player, bytes);
+		player.waiting = true;
+	}
+
+	// EFFECTS: Reads what the server sent client and handles every whole
+	// message
+	void read_messages(Client& client) {
+		unsigned char buffer[1 << 16];
+		ssize_t n = read(client.fd, buffer, sizeof(buffer));
+		if (n <= 0) throw Server_Error();
+		client.in.insert(client.in.end(), buffer, buffer + n);
+		size_t used = 0;
+		while (1) {
+			const unsigned char* data = client.in.data() + used;
+			size_t size = complete_message_size(data, client.in.size() - used, size_t(1) << 30);
+			if (size == 0) break;
+			handle_message(client, data, size);
+			used += size;
+		}
+		client.in.erase(client.in.begin(), client.in.begin() + used);
+	}
+
+	// EFFECTS: Handles one whole message from the server to client
+	void handle_message(Client& client, const unsigned char* data, size_t size) {
+		Message_Parser parser(data, size);
+		Message_Type type = message_type(data);
+		if (type == Message_Type::GAME_INFO) {
+			client.game = parser.get_u32();
+			client.cells.assign(size_t(width) * height, CELL_HIDDEN);
+			client.hidden = client.cells.size();
+			if (client.player) {
+				for (Client* spectator : client.spectators) {
+					send_game_message(*spectator, Message_Type::WATCH, client.game);
+				}
+				send_move(client);
+			}
+		}
+		else if (type == Message_Type::DELTA) {
+			handle_delta(client, parser);
+		}
+		else {
+			++errors;
+			client.waiting = false;
+		}
+	}
+
+	// EFFECTS: Applies a DELTA to client's board, then makes the next move
+	// or starts the next game
+	void handle_delta(Client& client, Message_Parser& parser) {
+		uint32_t game = parser.get_u32();
+		parser.get_u32();
+		Move_Status status = Move_Status(parser.get_u8());
+		Game_State state = Game_State(parser.get_u8());
+		uint32_t count = parser.get_u32();
+		if (game != client.game) return;
+		for (uint32_t i = 0; i < count; ++i) {
+			size_t cell = size_t(parser.get_varint());
+			unsigned char value = parser.get_u8();
+			if (cell >= client.cells.size()) throw Bad_Message();
+			if (client.cells[cell] == CELL_HIDDEN && value != CELL_HIDDEN) --client.hidden;
+			client.cells[cell] = value;
+		}
+
+		if (!client.player) {
+			++spectator_deltas;
+			if (state == Game_State::IN_PROGRESS) return;
+			send_game_message(client, Message_Type::LEAVE, game);
+			finish_board(client, game);
+			return;
+		}
+
+		auto now = chrono::steady_clock::now();
+		latencies.push_back(uint32_t(min<int64_t>(
+			chrono::duration_cast<chrono::nanoseconds>(now - client.sent).count(), UINT32_MAX)));
+		if (status != Move_Status::OK) ++errors;
+		else ++moves;
+		if (state == Game_State::IN_PROGRESS && client.hidden > 0 && status == Move_Status::OK) {
+			if (now < deadline) send_move(client);
+			else client.waiting = false;
+			return;
+		}
+		++games_finished;
+		if (state == Game_State::WON) ++games_won;
+		send_game_message(client, Message_Type::LEAVE, game);
+		finish_board(client, game);
+		if (now < deadline) start_game(client);
+		else client.waiting = false;
+	}
+
+	// EFFECTS: Keeps the board of game, which just ended for client, and
+	// checks it against the boards of the player and spectators that saw the
+	// end first
+	void finish_board(Client& client, uint32_t game) {
+		client.finished_game = game;
+		client.finished_cells = client.cells;
+		Client& player = client.player ? client : *client.watched;
+		if (client.player) {
+			for (Client* spectator : player.spectators) compare_boards(player, *spectator);
+		}
+		else compare_boards(player, client);
+	}
+
+	// EFFECTS: Checks the spectator saw the player's last game end the same way
+	void compare_boards(const Client& player, const Client& spectator) {
+		if (player.finished_game == 0 || player.finished_game != spectator.finished_game) return;
+		++boards_checked;
+		if (player.finished_cells != spectator.finished_cells) ++mismatches;
+	}
+};
+
+// EFFECTS: Returns the fraction-th latency (0 to 1) of the sorted latencies,
+// in microseconds
+double percentile(const vector<uint32_t>& sorted, double fraction) {
+	if (sorted.empty()) return 0;
+	size_t index = min(sorted.size() - 1, size_t(fraction * sorted.size()));
+	return sorted[index] / 1000.0;
+}
+
+// Main function
+int main(int argc, char** argv) {
+	string address;
+	int players = 1000;
+	int spectators = 1;
+	double seconds = 5;
+	uint64_t seed = 1;
+	int width = 30;
+	int height = 16;
+	int number_of_mines = 99;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--connect" && has_value) address = argv[++i];
+		else if (arg == "--clients" && has_value) players = atoi(argv[++i]);
+		else if (arg == "--spectators" && has_value) spectators = atoi(argv[++i]);
+		else if (arg == "--seconds" && has_value) seconds = atof(argv[++i]);
+		else if (arg == "--seed" && has_value) seed = strtoull(argv[++i], nullptr, 10);
+		else if (arg == "--board" && i + 3 < argc) {
+			width = atoi(argv[++i]);
+			height = atoi(argv[++i]);
+			number_of_mines = atoi(argv[++i]);
+		}
+		else {
+			address.clear();
+			break;
+		}
+	}
+	if (address.empty() || players <= 0 || spectators < 0 || width <= 1 || height <= 1) {
+		cerr << "Usage: " << argv[0] << " --connect ADDRESS [--clients N] [--spectators N]"
+			<< " [--seconds S] [--seed N] [--board W H M]" << endl;
+		return 1;
+	}
+
+	raise_open_file_limit();
+	try {
+		Load_Client load(address, players, spectators, width, height, number_of_mines, seed);
+		auto start = chrono::steady_clock::now();
+		load.run(seconds);
+		double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		sort(load.latencies.begin(), load.latencies.end());
+		cout << "Players: " << players << " (" << spectators << " spectators each)" << endl;
+		cout << "Games finished: " << load.games_finished << " (" << load.games_won << " won)" << endl;
+		cout << "Moves: " << load.moves << endl;
+		cout << "Moves per second: " << load.moves / elapsed << endl;
+		cout << "Move latency: p50 " << percentile(load.latencies, 0.5) << " us, p99 "
+			<< percentile(load.latencies, 0.99) << " us, max "
+			<< percentile(load.latencies, 1) << " us" << endl;
+		cout << "Spectator deltas: " << load.spectator_deltas << endl;
+		cout << "Spectator boards checked: " << load.boards_checked << " (" << load.mismatches
+			<< " different)" << endl;
+		cout << "Errors: " << load.errors << endl;
+		return load.mismatches == 0 && load.errors == 0 ? 0 : 1;
+	}
+	catch (const Server_Error&) {
+		cerr << "Error: Lost connection to the server at " << address << endl;
+	}
+	catch (const Bad_Message&) {
+		cerr << "Error: Server sent a message that doesn't make sense" << endl;
+	}
+	return 1;
+}
@@ -0,0 +1,542 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef MINE_PROBABILITY_H
+#define MINE_PROBABILITY_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "minesweeper_game.h"
+#include "thread_pool.h"
+
+// Mine Probability Map Class
+// Works out the exact chance that each hidden tile of a Minesweeper_Game has
+// a mine, from the numbers revealed so far and the number of mines.
+// Hidden tiles next to revealed numbers (the frontier) are split into
+// components that share no numbers. The ways of placing mines in each
+// component are counted for every number of mines it could hold. Tiles next
+// to exactly the same numbers form a class, and a class of s tiles holding j
+// mines is counted once, as C(s, j) ways. The components are then combined,
+// with the mines left over spread over the tiles away from the frontier in
+// C(tiles, mines) ways.
+// Flags and question marks are only the player's guesses, so those tiles
+// count as hidden.
+// Components are counted on the Thread_Pool if one is given. Each
+// component's counts are kept, so after a move only the components it
+// changed are counted again.
+class Mine_Probability_Map {
+public:
+	// Counts of the work done
+	struct Statistics {
+		uint64_t updates = 0;
+		uint64_t components_counted = 0;
+		uint64_t components_reused = 0;	// Unchanged since the update before
+		uint64_t search_steps = 0;
+	};
+
+private:
+	// Most search steps for one component. A component that takes longer
+	// gets estimated chances instead, and is_exact() is false
+	static const uint64_t MAX_SEARCH_STEPS = 1000000;
+
+	// What the map knows about each tile (see update())
+	static const unsigned char HIDDEN = 0xFF;
+	static const unsigned char OFF_BOARD = 0xFE;
+	static const unsigned char KNOWN_MINE = 0xFD;	// Revealed mine, once the game is lost
+
+	// Hidden tiles of a component that are next to exactly the same numbers
+	struct Tile_Class {
+		std::vector<size_t> tiles;
+		int numbers[8];		// Indexes into Component::targets
+		int number_count;
+	};
+
+	// Frontier tiles connected to each other through the numbers around them
+	struct Component {
+		std::vector<size_t> tiles;		// Tile indexes, in increasing order
+		std::vector<size_t> numbers;	// Revealed tiles next to them, in increasing order
+		std::vector<int> targets;		// Number on each of those tiles
+		std::vector<Tile_Class> classes;
+		uint64_t key;					// Hash of tiles and numbers
+		// Counts, filled in by count_component(). Scaled so the biggest
+		// weight is 1, which doesn't change any chances
+		std::vector<double> weights;		// [k]: ways of placing exactly k mines
+		std::vector<double> class_mines;	// [class * (tiles + 1) + k]: those ways
+											// times the mines they put in class
+		bool exact;
+	};
+
+	// Scratch space for counting one component. Each worker has its own
+	struct Counter {
+		std::vector<int> assigned;	// Mines placed around each number so far
+		std::vector<int> open;		// Tiles around each number not yet decided
+		std::vector<int> chosen;	// Mines placed in each class so far
+		uint64_t steps = 0;			// Search steps this update
+		uint64_t component_steps = 0;	// Search steps for the component being counted
+	};
+
+	Thread_Pool* pool;
+	int width;
+	int height;
+	size_t stride;
+	ptrdiff_t neighbour_offsets[8];
+	std::vector<unsigned char> known;	// Number on each revealed tile, or HIDDEN, OFF_BOARD, KNOWN_MINE
+	std::vector<double> chance;			// Chance of a mine on each tile
+	std::vector<int> local_id;			// Index of a number within its component, or -1
+	std::vector<uint32_t> visited;		// Equal to visit_number if visited this update
+	uint32_t visit_number;
+	std::unordered_map<uint64_t, std::unique_ptr<Component>> components;
+	std::vector<std::unique_ptr<Counter>> counters;	// One per worker
+	bool exact;
+	Statistics stats;
+
+public:
+	// Custom Constructor: Counts components on pool_in (null for this thread only)
+	explicit Mine_Probability_Map(Thread_Pool* pool_in = nullptr) : pool(pool_in), width(0),
+		height(0), stride(0), visit_number(0), exact(true) {
+		unsigned workers = pool ? pool->size() : 1;
+		for (unsigned i = 0; i < workers; ++i) counters.emplace_back(new Counter);
+	}
+
+	// EFFECTS: Works out the chances for game as it is now
+	// Note: Components that are the same as in the last update of a game with
+	// the same board keep their counts
+	void update(const Minesweeper_Game& game) {
+		++stats.updates;
+		read_board(game);
+		std::unordered_map<uint64_t, std::unique_ptr<Component>> found;
+		std::vector<Component*> to_count;
+		size_t frontier_tiles = 0;
+		for (size_t tile = stride; tile < known.size() - stride; ++tile) {
+			if (!is_number(tile) || visited[tile] == visit_number || !next_to_hidden(tile)) continue;
+			std::unique_ptr<Component> component = collect_component(tile);
+			frontier_tiles += component->tiles.size();
+			std::unique_ptr<Component> kept = take_unchanged(*component);
+			if (kept) {
+				++stats.components_reused;
+				component = std::move(kept);
+			}
+			else to_count.push_back(component.get());
+			// Keys only clash by chance, keep the clashing component uncached
+			uint64_t key = component->key;
+			while (found.count(key)) ++key;
+			found[key] = std::move(component);
+		}
+		components.swap(found);
+
+		int mines_left = mines_not_revealed(game);
+		count_components(to_count, mines_left);
+		combine(mines_left, frontier_tiles);
+	}
+
+	// EFFECTS: Returns the chance from 0 to 1 that the tile at row and col
+	// has a mine, as of the last update(). Revealed tiles are 0, or 1 for a
+	// revealed mine
+	double mine_chance(int row, int col) const {
+		return chance[(size_t(row) + 1) * stride + size_t(col) + 1];
+	}
+
+	// EFFECTS: Returns false if any component of the last update() took too
+	// long to count, so its chances are only estimates
+	bool is_exact(void) const {
+		return exact;
+	}
+
+	// EFFECTS: Returns number of components found by the last update()
+	size_t number_of_components(void) const {
+		return components.size();
+	}
+
+	// EFFECTS: Returns counts of the work done since the map was made
+	const Statistics& statistics(void) const {
+		return stats;
+	}
+
+private:
+	// EFFECTS: Copies what the player can see of game into known[]
+	void read_board(const Minesweeper_Game& game) {
+		if (game.get_width() != width || game.get_height() != height) {
+			width = game.get_width();
+			height = game.get_height();
+			stride = size_t(width) + 2;
+			ptrdiff_t s = ptrdiff_t(stride);
+			ptrdiff_t offsets[8] = { -s, -s + 1, 1, s + 1, s, s - 1, -1, -s - 1 };
+			std::copy(offsets, offsets + 8, neighbour_offsets);
+			size_t size = (size_t(height) + 2) * stride;
+			known.assign(size, (unsigned char)OFF_BOARD);
+			chance.assign(size, 0);
+			local_id.assign(size, -1);
+			visited.assign(size, 0);
+			components.clear();
+		}
+		++visit_number;
+		for (int row = 0; row < height; ++row) {
+			unsigned char* line = &known[(size_t(row) + 1) * stride + 1];
+			for (int col = 0; col < width; ++col) {
+				if (!game.is_revealed(row, col)) line[col] = HIDDEN;
+				else if (game.has_mine(row, col)) line[col] = KNOWN_MINE;
+				else line[col] = (unsigned char)game.number_of_nearby_mines(row, col);
+			}
+		}
+	}
+
+	// EFFECTS: Returns true if tile is revealed and shows a number
+	bool is_number(size_t tile) const {
+		return known[tile] <= 8;
+	}
+
+	// EFFECTS: Returns true if any tile around tile is hidden
+	bool next_to_hidden(size_t tile) const {
+		for (int i = 0; i < 8; ++i) {
+			if (known[tile + neighbour_offsets[i]] == HIDDEN) return true;
+		}
+		return false;
+	}
+
+	// EFFECTS: Returns the mines that aren't revealed
+	int mines_not_revealed(const Minesweeper_Game& game) const {
+		int mines = game.get_number_of_mines();
+		for (unsigned char tile : known) mines -= tile == KNOWN_MINE;
+		return mines;
+	}
+
+	// EFFECTS: Returns the component of hidden tiles and numbers connected
+	// to number, with its tiles split into classes
+	std::unique_ptr<Component> collect_component(size_t number) {
+		std::unique_ptr<Component> component(new Component);
+		std::vector<size_t>& numbers = component->numbers;
+		std::vector<size_t>& tiles = component->tiles;
+		visited[number] = visit_number;
+		numbers.push_back(number);
+		for (size_t next = 0; next < numbers.size(); ++next) {
+			size_t current = numbers[next];
+			for (int i = 0; i < 8; ++i) {
+				size_t tile = current + neighbour_offsets[i];
+				if (known[tile] != HIDDEN || visited[tile] == visit_number) continue;
+				visited[tile] = visit_number;
+				tiles.push_back(tile);
+				for (int j = 0; j < 8; ++j) {
+					size_t other = tile + neighbour_offsets[j];
+					if (!is_number(other) || visited[other] == visit_number) continue;
+					visited[other] = visit_number;
+					numbers.push_back(other);
+				}
+			}
+		}
+		std::sort(tiles.begin(), tiles.end());
+		std::sort(numbers.begin(), numbers.end());
+		uint64_t key = tiles.size();
+		for (size_t tile : tiles) key = mix_64(key ^ tile);
+		for (size_t tile : numbers) key = mix_64(key ^ (tile << 1));
+		component->key = key;
+		for (size_t i = 0; i < numbers.size(); ++i) {
+			local_id[numbers[i]] = int(i);
+			// Mines already revealed (only once the game is lost) are taken off
+			int target = known[numbers[i]];
+			for (int j = 0; j < 8; ++j) target -= known[numbers[i] + neighbour_offsets[j]] == KNOWN_MINE;
+			component->targets.push_back(target);
+		}
+		make_classes(*component);
+		for (size_t tile : numbers) local_id[tile] = -1;
+		return component;
+	}
+
+	// REQUIRES: local_id[] holds the index of each of component's numbers
+	// EFFECTS: Splits component's tiles into classes by the numbers around them
+	void make_classes(Component& component) {
+		struct Tile_Numbers {
+			int ids[8];
+			int count;
+			size_t tile;
+			bool operator<(const Tile_Numbers& other) const {
+				return std::lexicographical_compare(ids, ids + count, other.ids, other.ids + other.count);
+			}
+			bool operator==(const Tile_Numbers& other) const {
+				return count == other.count && std::equal(ids, ids + count, other.ids);
+			}
+		};
+		std::vector<Tile_Numbers> around(component.tiles.size());
+		for (size_t i = 0; i < component.tiles.size(); ++i) {
+			Tile_Numbers& entry = around[i];
+			entry.tile = component.tiles[i];
+			entry.count = 0;
+			for (int j = 0; j < 8; ++j) {
+				int id = local_id[entry.tile + neighbour_offsets[j]];
+				if (id >= 0) entry.ids[entry.count++] = id;
+			}
+			std::sort(entry.ids, entry.ids + entry.count);
+		}
+		// Sorting by the numbers also puts classes next to the same numbers
+		// close together, so the search settles each number early
+		std::stable_sort(around.begin(), around.end());
+		for (size_t i = 0; i < around.size(); ++i) {
+			if (i == 0 || !(around[i] == around[i - 1])) {
+				component.classes.emplace_back();
+				Tile_Class& added = component.classes.back();
+				added.number_count = around[i].count;
+				std::copy(around[i].ids, around[i].ids + around[i].count, added.numbers);
+			}
+			component.classes.back().tiles.push_back(around[i].tile);
+		}
+	}
+
+	// EFFECTS: Returns the component from the last update with the same
+	// tiles and numbers as component (taking it out of components), or null
+	std::unique_ptr<Component> take_unchanged(const Component& component) {
+		for (uint64_t key = component.key; ; ++key) {
+			auto old = components.find(key);
+			if (old == components.end()) return nullptr;
+			if (old->second && old->second->tiles == component.tiles && old->second->numbers == component.numbers) {
+				return std::move(old->second);
+			}
+		}
+	}
+
+	// EFFECTS: Counts the ways of placing mines in every component of
+	// to_count, which can hold at most max_mines mines each
+	void count_components(const std::vector<Component*>& to_count, int max_mines) {
+		stats.components_counted += to_count.size();
+		for (const std::unique_ptr<Counter>& counter : counters) counter->steps = 0;
+		if (pool && to_count.size() > 1) {
+			pool->parallel_for(to_count.size(), 1, [&](unsigned worker, size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i) count_component(*to_count[i], max_mines, *counters[worker]);
+			});
+		}
+		else {
+			for (Component* component : to_count) count_component(*component, max_mines, *counters[0]);
+		}
+		for (const std::unique_ptr<Counter>& counter : counters) stats.search_steps += counter->steps;
+	}
+
+	// EFFECTS: Fills in the weights and class mines of component
+	void count_component(Component& component, int max_mines, Counter& counter) {
+		size_t length = component.tiles.size() + 1;
+		component.weights.assign(length, 0);
+		component.class_mines.assign(component.classes.size() * length, 0);
+		counter.assigned.assign(component.targets.size(), 0);
+		counter.open.assign(component.targets.size(), 0);
+		counter.chosen.assign(component.classes.size(), 0);
+		for (const Tile_Class& tile_class : component.classes) {
+			for (int n = 0; n < tile_class.number_count; ++n) {
+				counter.open[tile_class.numbers[n]] += int(tile_class.tiles.size());
+			}
+		}
+		counter.component_steps = 0;
+		search(component, counter, 0, 0, 1.0, max_mines);
+		counter.steps += counter.component_steps;
+		component.exact = counter.component_steps <= MAX_SEARCH_STEPS;
+		if (!component.exact) estimate_component(component, max_mines);
+
+		double biggest = *std::max_element(component.weights.begin(), component.weights.end());
+		if (biggest > 0) {
+			for (double& weight : component.weights) weight /= biggest;
+			for (double& mines : component.class_mines) mines /= biggest;
+		}
+	}
+
+	// EFFECTS: Tries every number of mines for class next, and for each one
+	// that agrees with the numbers, goes on to the next class. mines is the
+	// number placed so far and weight the number of ways of placing them
+	void search(Component& component, Counter& counter, size_t next, int mines, double weight, int max_mines) {
+		if (++counter.component_steps > MAX_SEARCH_STEPS) return;
+		if (next == component.classes.size()) {
+			size_t length = component.tiles.size() + 1;
+			component.weights[mines] += weight;
+			for (size_t c = 0; c < component.classes.size(); ++c) {
+				if (counter.chosen[c]) component.class_mines[c * length + mines] += weight * counter.chosen[c];
+			}
+			return;
+		}
+		const Tile_Class& tile_class = component.classes[next];
+		int size = int(tile_class.tiles.size());
+		int low = 0;
+		int high = std::min(size, max_mines - mines);
+		for (int n = 0; n < tile_class.number_count; ++n) {
+			int id = tile_class.numbers[n];
+			counter.open[id] -= size;
+			int needed = component.targets[id] - counter.assigned[id];
+			low = std::max(low, needed - counter.open[id]);
+			high = std::min(high, needed);
+		}
+		for (int j = low; j <= high; ++j) {
+			for (int n = 0; n < tile_class.number_count; ++n) counter.assigned[tile_class.numbers[n]] += j;
+			counter.chosen[next] = j;
+			search(component, counter, next + 1, mines + j, weight * binomial(size, j), max_mines);
+			for (int n = 0; n < tile_class.number_count; ++n) counter.assigned[tile_class.numbers[n]] -= j;
+		}
+		counter.chosen[next] = 0;
+		for (int n = 0; n < tile_class.number_count; ++n) counter.open[tile_class.numbers[n]] += size;
+	}
+
+	// EFFECTS: Gives every tile of component the chance of a mine of the
+	// most crowded number next to it, like Minesweeper_Solver does for groups
+	// too big to enumerate, and puts all of the weight on the number of mines
+	// those chances add up to
+	void estimate_component(Component& component, int max_mines) {
+		size_t length = component.tiles.size() + 1;
+		std::vector<int> hidden(component.targets.size(), 0);
+		for (const Tile_Class& tile_class : component.classes) {
+			for (int n = 0; n < tile_class.number_count; ++n) hidden[tile_class.numbers[n]] += int(tile_class.tiles.size());
+		}
+		std::vector<double> class_chance(component.classes.size(), 0);
+		double expected = 0;
+		for (size_t c = 0; c < component.classes.size(); ++c) {
+			const Tile_Class& tile_class = component.classes[c];
+			for (int n = 0; n < tile_class.number_count; ++n) {
+				int id = tile_class.numbers[n];
+				class_chance[c] = std::max(class_chance[c], double(component.targets[id]) / hidden[id]);
+			}
+			expected += class_chance[c] * tile_class.tiles.size();
+		}
+		size_t mines = std::min(size_t(std::lround(expected)), std::min(length - 1, size_t(std::max(0, max_mines))));
+		std::fill(component.weights.begin(), component.weights.end(), 0);
+		std::fill(component.class_mines.begin(), component.class_mines.end(), 0);
+		component.weights[mines] = 1;
+		for (size_t c = 0; c < component.classes.size(); ++c) {
+			component.class_mines[c * length + mines] = class_chance[c] * component.classes[c].tiles.size();
+		}
+	}
+
+	// EFFECTS: Works out every tile's chance from the component counts.
+	// mines_left mines are hidden, frontier_tiles of the hidden tiles are in
+	// components and the rest are free
+	// Note: later[i][t] is the weight of components [i, end) and the free
+	// tiles together, when t mines are already placed before them. For
+	// component i, before[j] is the weight of components [0, i) holding j
+	// mines. Both are scaled as they go, which scales every count of a
+	// component the same, so this is O(components * mines * tiles per component)
+	void combine(int mines_left, size_t frontier_tiles) {
+		exact = true;
+		size_t hidden = 0;
+		for (size_t tile = 0; tile < known.size(); ++tile) {
+			if (known[tile] == HIDDEN) ++hidden;
+			chance[tile] = known[tile] == KNOWN_MINE ? 1 : 0;
+		}
+		size_t free_tiles = hidden - frontier_tiles;
+		size_t max_mines = size_t(std::max(0, mines_left));
+
+		// Ways of placing the other mines on the free tiles, when the
+		// components hold j mines: C(free_tiles, mines_left - j)
+		std::vector<double> free_ways(max_mines + 1, 0);
+		double biggest = -INFINITY;
+		for (size_t j = 0; j <= max_mines; ++j) {
+			size_t rest = max_mines - j;
+			if (rest > free_tiles) continue;
+			free_ways[j] = log_binomial(free_tiles, rest);
+			biggest = std::max(biggest, free_ways[j]);
+		}
+		for (size_t j = 0; j <= max_mines; ++j) {
+			size_t rest = max_mines - j;
+			free_ways[j] = rest > free_tiles ? 0 : std::exp(free_ways[j] - biggest);
+		}
+
+		std::vector<Component*> list;
+		for (auto& entry : components) {
+			list.push_back(entry.second.get());
+			exact = exact && entry.second->exact;
+		}
+		std::vector<std::vector<double>> later(list.size() + 1);
+		later[list.size()] = free_ways;
+		for (size_t i = list.size(); i-- > 0;) {
+			const std::vector<double>& weights = list[i]->weights;
+			std::vector<double>& current = later[i];
+			current.assign(max_mines + 1, 0);
+			for (size_t t = 0; t <= max_mines; ++t) {
+				for (size_t k = 0; k < weights.size() && t + k <= max_mines; ++k) {
+					current[t] += weights[k] * later[i + 1][t + k];
+				}
+			}
+			scale_to_one(current);
+		}
+
+		std::vector<double> before(1, 1);
+		for (size_t i = 0; i < list.size(); ++i) {
+			Component& component = *list[i];
+			// ways[k]: weight of everything outside the component when it holds k mines
+			size_t length = component.tiles.size() + 1;
+			std::vector<double> ways(length, 0);
+			double total = 0;
+			for (size_t k = 0; k < length && k <= max_mines; ++k) {
+				for (size_t j = 0; j < before.size() && j + k <= max_mines; ++j) ways[k] += before[j] * later[i + 1][j + k];
+				total += component.weights[k] * ways[k];
+			}
+			before = convolve(before, component.weights, max_mines);
+			if (total <= 0) continue;
+			for (size_t c = 0; c < component.classes.size(); ++c) {
+				const Tile_Class& tile_class = component.classes[c];
+				double mines = 0;
+				for (size_t k = 0; k < length && k <= max_mines; ++k) mines += component.class_mines[c * length + k] * ways[k];
+				double tile_chance = mines / (total * tile_class.tiles.size());
+				for (size_t tile : tile_class.tiles) chance[tile] = tile_chance;
+			}
+		}
+
+		// Free tiles share the mines the components leave over
+		if (free_tiles > 0) {
+			const std::vector<double>& all = before;
+			double total = 0;
+			double mines = 0;
+			for (size_t j = 0; j < all.size(); ++j) {
+				total += all[j] * free_ways[j];
+				mines += all[j] * free_ways[j] * double(max_mines - j);
+			}
+			double free_chance = total > 0 ? mines / (total * free_tiles) : 0;
+			for (size_t tile = 0; tile < known.size(); ++tile) {
+				if (known[tile] == HIDDEN && visited[tile] != visit_number) chance[tile] = free_chance;
+			}
+		}
+	}
+
+	// EFFECTS: Returns the convolution of a and b, cut off after max_mines,
+	// scaled so its biggest value is 1
+	static std::vector<double> convolve(const std::vector<double>& a, const std::vector<double>& b, size_t max_mines) {
+		size_t length = std::min(a.size() + b.size() - 1, max_mines + 1);
+		std::vector<double> result(length, 0);
+		for (size_t i = 0; i < a.size() && i < length; ++i) {
+			if (a[i] == 0) continue;
+			for (size_t j = 0; j < b.size() && i + j < length; ++j) result[i + j] += a[i] * b[j];
+		}
+		scale_to_one(result);
+		return result;
+	}
+
+	// EFFECTS: Divides every value by the biggest one, if it isn't 0
+	static void scale_to_one(std::vector<double>& values) {
+		double biggest = 0;
+		for (double value : values) biggest = std::max(biggest, value);
+		if (biggest > 0) {
+			for (double& value : values) value /= biggest;
+		}
+	}
+
+	// EFFECTS: Returns C(n, k) for a class of at most 8 tiles
+	static double binomial(int n, int k) {
+		static const double table[9][9] = {
+			{ 1 },
+			{ 1, 1 },
+			{ 1, 2, 1 },
+			{ 1, 3, 3, 1 },
+			{ 1, 4, 6, 4, 1 },
+			{ 1, 5, 10, 10, 5, 1 },
+			{ 1, 6, 15, 20, 15, 6, 1 },
+			{ 1, 7, 21, 35, 35, 21, 7, 1 },
+			{ 1, 8, 28, 56, 70, 56, 28, 8, 1 }
+		};
+		return table[n][k];
+	}
+
+	// EFFECTS: Returns the natural log of C(n, k)
+	static double log_binomial(size_t n, size_t k) {
+		return std::lgamma(double(n) + 1) - std::lgamma(double(k) + 1) - std::lgamma(double(n - k) + 1);
+	}
+};
+
+#endif
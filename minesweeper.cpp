@@ -8,132 +8,235 @@
 #include <string>
 #include "assert.h"
 #include <cassert>
-#include <random>
+#include <chrono>
+#include <cstdint>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "board_generator.h"
+#include "board_renderer.h"
+#include "board_snapshot.h"
+#include "chunked_game.h"
+#include "command_input.h"
+#include "fixed_board.h"
+#include "game_server.h"
+#include "instrumentation.h"
+#include "mine_probability.h"
+#include "minesweeper_game.h"
+#include "move_log.h"
+#include "simulation.h"
+#include "solver.h"
+#include "thread_pool.h"
 
 using namespace std;
 
 // Exceptions
-class Improper_Dimensions {};
-class Improper_Number_of_Mines {};
 class Invalid_Arguements {};
 
-// Minesweeper Class
-class Minesweeper_Game {
+// EFFECTS: Tells the user why a move was refused
+void print_refused_move(Move_Status status) {
+	if (status == Move_Status::ALREADY_REVEALED) {
+		cout << "Tile already revealed. Try again." << endl;
+	}
+	else if (status == Move_Status::FLAGGED) {
+		cout << "Tile is flagged. Try again." << endl;
+	}
+	else if (status == Move_Status::NOT_REVEALED) {
+		cout << "Only revealed tiles can be chorded. Try again." << endl;
+	}
+	else if (status == Move_Status::WRONG_NUMBER_OF_FLAGS) {
+		cout << "Flag as many tiles around it as its number first. Try again." << endl;
+	}
+	else cout << "Invalid dimensions" << endl;
+}
+
+// EFFECTS: Reads moves from commands until the user picks a tile that can
+// be revealed, then reveals it. Returns the tile picked in row and col
+// before_reveal(row, col) is called with each tile picked, just before it is
+// revealed. Game is Minesweeper_Game or Chunked_Minesweeper_Game
+template <class Game, class Before_Reveal>
+void read_and_reveal_tile(Game& game, Command_Reader& commands, int& row, int& col,
+	Before_Reveal before_reveal) {
+	// Notes: If the user picks a tile that is already revealed, loop back
+	// until user picks a tile that isn't already revealed
+	while (1) {
+		Command command = commands.read_move(true);
+		row = command.row;
+		col = command.col;
+		before_reveal(row, col);
+		Move_Result result = game.reveal(row, col);
+		if (result.status == Move_Status::OK) return;
+		print_refused_move(result.status);
+	}
+}
+
+// EFFECTS: Same as above, with nothing to do before a reveal
+template <class Game>
+void read_and_reveal_tile(Game& game, Command_Reader& commands, int& row, int& col) {
+	read_and_reveal_tile(game, commands, row, col, [](int, int) {});
+}
+
+// EFFECTS: Makes the move action on the tile at row and col
+// before_reveal(row, col) is called first if the move is a reveal
+template <class Before_Reveal>
+Move_Result make_move(Minesweeper_Game& game, Move_Action action, int row, int col,
+	Before_Reveal before_reveal) {
+	if (action == Move_Action::REVEAL) {
+		before_reveal(row, col);
+		return game.reveal(row, col);
+	}
+	if (action == Move_Action::FLAG) return game.flag(row, col);
+	if (action == Move_Action::QUESTION) return game.question(row, col);
+	return game.chord(row, col);
+}
+
+// EFFECTS: Reads moves from commands (see Command_Reader) until the user
+// makes one the game accepts. Returns the tile picked in row and col
+// Actions: "r" reveals, "f" flags or unflags, "q" question marks or unmarks,
+// and "c" chords (reveals every tile around a revealed number that isn't
+// flagged, once that number of tiles around it are flagged)
+// before_reveal(row, col) is called with each tile picked to be revealed,
+// just before it is revealed
+template <class Before_Reveal>
+void read_and_make_move(Minesweeper_Game& game, Command_Reader& commands, int& row, int& col,
+	Before_Reveal before_reveal) {
+	while (1) {
+		Command command = commands.read_move(false);
+		row = command.row;
+		col = command.col;
+		Move_Result result = make_move(game, command.action, row, col, before_reveal);
+		if (result.status == Move_Status::OK) return;
+		print_refused_move(result.status);
+	}
+}
+
+// How a game in the terminal is set up
+struct Console_Options {
+	bool board_ready = false;		// Board was loaded from a snapshot, so don't start a new one
+	string save_path;				// Snapshot file saved when the game or input ends ("" for none)
+	Move_Log_Writer* log = nullptr;	// Every move is recorded here (null for none)
+	No_Guess_Generator* generator = nullptr;	// Picks a board that needs no guesses
+												// once the first tile is picked (null for any board)
+	Mine_Probability_Map* mine_chances = nullptr;	// Shown under the board after every
+													// move (null for none)
+	Command_Reader* commands = nullptr;	// Moves are read from here
+	bool draw_every_move = true;		// If false, the board is only drawn when the game ends
+	Key_Reader* keys = nullptr;			// If set, moves are picked with a cursor
+										// and single keys instead of commands
+};
+
+// Console Class
+// Plays a Minesweeper_Game in the terminal. Moves are read as commands (or
+// keys, with a cursor on the board) and the board is drawn with a Board_Renderer. All of the rules live in
+// Minesweeper_Game, this class only does the input and output.
+class Minesweeper_Console {
 private:
-	struct Tile {	// Note: Tile is just "plain old data". No need
-					// to use dynamic programming
-		bool is_revealed;	// Indicates if tile has been revealed of not
-		bool has_mine;		// If true, then tile contains a mine
-		int number_of_nearby_mines; // Indicates number nearby mines in all directions
-									// N, NE, E, SE, S, SW, W, NW
-		
-		// Tile pointers that point to other tiles around current tile
-		Tile* north;
-		Tile* northeast;
-		Tile* east;
-		Tile* southeast;
-		Tile* south;
-		Tile* southwest;
-		Tile* west;
-		Tile* northwest;
-	};
-	Tile* board[1000];	// MAX SIZE = 1000, change as needed
-						// Note: board[] is an array of Tile pointers
-	Tile** board_start; // Tile pointer to start of board
-	int width;
-	int height;
-	int total_number_of_tiles;
-	int number_of_mines;
-	bool hit_mine;
+	Minesweeper_Game& game;
+	Board_Renderer renderer;	// Draws the board to the terminal
+	Console_Options options;
+	Minesweeper_Solver solver;	// Plays with --autoplay, kept for every game
+	int cursor_row;				// Tile under the cursor when moves are picked with keys
+	int cursor_col;
 
 public:
 
-	// Default Constructor (14x18 board with 40 mines)
-	Minesweeper_Game() : width(14), height(18), number_of_mines(40), 
-		total_number_of_tiles(14*18), hit_mine(false) {
-		board_start = board;
+	// Custom Constructor: Specify game to play and how
+	Minesweeper_Console(Minesweeper_Game& game_in, const Console_Options& options_in) :
+		game(game_in), options(options_in), solver(true),
+		cursor_row(game_in.get_height() / 2), cursor_col(game_in.get_width() / 2) {}
+
+	// EFFECTS: Runs number_of_games games one after another, played by the
+	// user or (if autoplay is true) the solver. Each game after the first
+	// gets a seed made from the first one's
+	// Note: The game and solver reuse their memory, so only the first game
+	// allocates (see Minesweeper_Game::new_game())
+	void run_games(uint64_t number_of_games, bool autoplay) {
+		uint64_t first_seed = game.get_seed();
+		for (uint64_t i = 0; i < number_of_games; ++i) {
+			if (i > 0) {
+				game.set_seed(simulation_seed(first_seed, i));
+				renderer.invalidate();
+				cout << endl;
+			}
+			if (autoplay) run_autoplay();
+			else run_game();
+		}
 	}
 
-	// Custom Constructor: Specify width and height. Number of mines default 20
-	Minesweeper_Game(int width_in, int height_in) : 
-		width(width_in), height(height_in), total_number_of_tiles(width_in * height_in),
-		number_of_mines(20), hit_mine(false) {
-		board_start = board;
+	// EFFECTS: Runs game of Minesweeper
+	void run_game(void) {
+		cout << "Seed: " << game.get_seed() << endl;
+		if (!options.board_ready) game.start_game();
 		try {
-			Improper_Dimensions error_1;
-			if(width_in <= 1 || height_in <= 1) throw error_1;
+			run_game_helper();
 		}
-		catch (const Improper_Dimensions& obj_1) {
-			cout << "Error: Improper Dimensions. Ending Program." << endl;
+		catch (const End_Of_Input&) {
+			// Saved so the game can be carried on with --load
+			save();
+			throw;
 		}
+		save();
+		if (options.log) options.log->finish(game);
+		print_stats();
 	}
 
-	// Custom Constructor: Specify width, height, and number of mines
-	Minesweeper_Game(int width_in, int height_in, int number_of_mines_in) :
-		width(width_in), height(height_in), number_of_mines(number_of_mines_in),
-		total_number_of_tiles(width_in * height_in), hit_mine(false) {
-		board_start = board;
-		try {
-			Improper_Dimensions error_1;
-			Improper_Number_of_Mines error_2;
-			if (width_in <= 1 || height_in <= 1) throw error_1;
-			if (number_of_mines_in <= 0 || number_of_mines_in > width_in * height_in) throw error_2;
+	// EFFECTS: Lets the solver play the game, then prints the board and how
+	// quickly the solver made its moves
+	void run_autoplay(void) {
+		cout << "Seed: " << game.get_seed() << endl;
+		if (!options.board_ready) game.start_game();
+		if (options.generator && !game.mines_placed()) {
+			// The solver's first move would be a guess, so start from the middle
+			int row = game.get_height() / 2;
+			int col = game.get_width() / 2;
+			choose_no_guess_board(row, col);
+			game.reveal(row, col);
+			if (options.log) options.log->record(game);
 		}
-		catch (const Improper_Dimensions& obj_1) {
-			cout << "Error: Improper dimensions. Ending program." << endl;
+		Minesweeper_Solver::Statistics before = solver.statistics();
+		solver.new_game(game, game.get_seed());
+		auto start = chrono::steady_clock::now();
+		while (game.state() == Game_State::IN_PROGRESS) {
+			Move_Result result = solver.play_move(game);
+			// A refused move would be picked again, so stop instead of spinning
+			if (result.status != Move_Status::OK) {
+				cout << "The solver's move was refused, stopping" << endl;
+				break;
+			}
+			if (options.log) options.log->record(game);
 		}
-		catch (const Improper_Number_of_Mines& obj_2) {
-			cout << "Error: Improper number of mines: Ending program." << endl;
+		auto end = chrono::steady_clock::now();
+		double seconds = chrono::duration<double>(end - start).count();
+		save();
+		if (game.state() == Game_State::IN_PROGRESS) {
+			if (options.log) options.log->flush();
+			print_board();
 		}
-	}
-
-	// Destructor
-	~Minesweeper_Game() {
-		// Make sure to delete all dynamically allocated
-		// tiles in board[]
-		for (size_t i = 0; i < total_number_of_tiles; ++i) delete board[i];
-	}
-	
-	// EFFECTS: Runs game of Minesweeper
-	void run_game(void) {
-		make_board();
-		place_mines();
-		run_game_helper();
-	}
-
-	// EFFECTS: Places mines for testing and debugging
-	// For debugging and testing purposes only
-	void place_mines_debug(void) {
-		// 15 22 34 42 53 60 62 67 68 74
-		board[15]->has_mine = true;
-		board[22]->has_mine = true;
-		board[34]->has_mine = true;
-		board[42]->has_mine = true;
-		board[53]->has_mine = true;
-		board[60]->has_mine = true;
-		board[62]->has_mine = true;
-		board[67]->has_mine = true;
-		board[68]->has_mine = true;
-		board[74]->has_mine = true;
-
-		// Update the number of nearby mines for each tile
-		for (size_t i = 0; i < total_number_of_tiles; ++i) {
-			look_for_mines_nearby(board[i]);
+		else {
+			if (options.log) options.log->finish(game);
+			print_board_when_game_over();
+			if (game.state() == Game_State::LOST) cout << "Game Over! Hit Mine!" << endl;
+			else cout << "You Won!" << endl;
 		}
-		// Uncomment for debugging purposes
-		//reveal_mines();
+		uint64_t decisions = solver.statistics().decisions - before.decisions;
+		uint64_t guesses = solver.statistics().guesses - before.guesses;
+		cout << "Decisions: " << decisions << " (" << guesses << " guesses)" << endl;
+		cout << "Decisions per second: " << (seconds > 0 ? decisions / seconds : 0) << endl;
+		print_stats();
 	}
 
 	// EFFECTS: Output location of all mines
 	// For debugging and testing purposes only
 	void reveal_mines(void) {
-		for (size_t i = 0; i < total_number_of_tiles; ++i) {
-			if (board[i]->has_mine == true) {
-				Tile* current_tile = board[i];
-				int current_row = row_index(current_tile);
-				int current_col = column_index(current_tile);
-				cout << "Mine placed at row " << current_row << " col " << current_col;
-				cout << " / tile " << tile_index(current_row, current_col) << endl;
+		for (int row = 0; row < game.get_height(); ++row) {
+			for (int col = 0; col < game.get_width(); ++col) {
+				if (game.has_mine(row, col)) {
+					cout << "Mine placed at row " << row << " col " << col;
+					cout << " / tile " << game.tile_number(row, col) << endl;
+				}
 			}
 		}
 	}
@@ -143,444 +246,566 @@ public:
 	// If the tile isn't a mine, then run reveal function and take in
 	// more input from user.
 	void run_game_helper(void) {
-		while (hit_mine == false) {
-			if (check_if_win() == true) break;
-			print_board();
+		while (game.state() == Game_State::IN_PROGRESS) {
+			if (options.draw_every_move) print_board();
+			if (options.mine_chances) print_mine_chances();
 			pick_tile();
 		}
-		if (hit_mine == true) {
-			print_board_when_game_over();
-			cout << "Game Over! Hit Mine!" << endl;
-		}
-		if (check_if_win() == true) {
-			print_board_when_game_over();
-			cout << "You Won!" << endl;
-		}
+		print_board_when_game_over();
+		if (game.state() == Game_State::LOST) cout << "Game Over! Hit Mine!" << endl;
+		else cout << "You Won!" << endl;
 	}
 
-	// EFFECTS: Checks user has revealed all tiles don't have mines, if so
-	// then returns true. Otherwise, returns false.
-	bool check_if_win(void) {
-		for (size_t i = 0; i < total_number_of_tiles; ++i) {
-			if (board[i]->has_mine) continue;
-			else if (board[i]->has_mine == false && board[i]->is_revealed == false) return false;
-		}
-		return true;
-	}
-
-	// EFFECTS: User inputs row and column. Then reveals the tiles
+	// EFFECTS: User inputs a move and a row and column. Then makes the move
 	void pick_tile(void) {
-		// Notes: If the user picks a tile that is already revealed, loop back
-		// until user picks a tile that isn't already revealed
 		int row_chosen, column_chosen;
-		while (1) {
-			cout << "Input row: ";
-			cin >> row_chosen;
-			cout << "Input col: ";
-			cin >> column_chosen;
-			int i = row_chosen * width + column_chosen;
-			if (valid_dimensions_chosen(row_chosen, column_chosen)) {
-				// Check if tile was already chosen
-				if (Tile_at(row_chosen, column_chosen)->is_revealed) {
-					cout << "Tile already revealed. Try again." << endl;
-					continue;
-				}
-				else break;
+		auto before_reveal = [this](int row, int col) {
+			if (options.generator && !game.mines_placed() && game.valid_dimensions_chosen(row, col)) {
+				choose_no_guess_board(row, col);
 			}
-			else cout << "Invalid dimensions" << endl;
-		}
-		// Here, we can assume the user has chosen a valid tile that has not
-		// yet been revealed
-		Tile* tile_chosen = Tile_at(row_chosen, column_chosen);
-
-		// Reveal tile_chosen
-		tile_chosen->is_revealed = true;
-
-		// Check if tile is a mine, if so then game over
-		if (tile_chosen->has_mine) {
-			hit_mine = true;
-			return;
+		};
+		if (options.keys) read_move_with_keys(row_chosen, column_chosen, before_reveal);
+		else read_and_make_move(game, *options.commands, row_chosen, column_chosen, before_reveal);
+		// Written straight away so the log survives the game being cut short
+		if (options.log) {
+			options.log->record(game);
+			options.log->flush();
 		}
+		renderer.set_focus(row_chosen, column_chosen);
+	}
 
-		// Then run recursive helper function
-		tile_reveal_recursive_func(tile_chosen);
-	}
-		
-	// EFFECTS: Given a tile, will reveal all other tiles in all directions it until
-	// tile have more than one nearby mine
-	void tile_reveal_recursive_func(Tile* current_tile) {
-		// -----dubugging-----
-		Tile** temp = board_start;
-		while (*temp != current_tile) ++temp;
-		int board_index = temp - board_start; // For debugging purposes
-		// -------------------
-		current_tile->is_revealed = true;
-
-		// Base Case: Stop when current_tile's number_of_nearby_mines > 0
-		if (current_tile->number_of_nearby_mines > 0) {
-			current_tile->is_revealed = true;
-			return;
-		}
-		// Recursive Case: Look north, east, south, west, northwest, northeast
-		// southwest, and southeast
-		if (current_tile->north) { 
-			if (current_tile->north->is_revealed == false) {
-				tile_reveal_recursive_func(current_tile->north);
+	// EFFECTS: Moves the cursor around the board with the keys until a move
+	// the game accepts is made on the tile under it. Returns that tile in row
+	// and col. before_reveal is called like in read_and_make_move()
+	template <class Before_Reveal>
+	void read_move_with_keys(int& row, int& col, Before_Reveal before_reveal) {
+		bool redraw = true;
+		while (1) {
+			if (redraw) {
+				renderer.set_focus(cursor_row, cursor_col);
+				print_board();
+				cout << "Arrows move, Space reveals, f flags, q question marks, c chords, Esc quits" << endl;
 			}
-		}
-		if (current_tile->east) {
-			if (current_tile->east->is_revealed == false) {
-				tile_reveal_recursive_func(current_tile->east);
+			renderer.place_cursor(cursor_row, cursor_col);
+			Key key = options.keys->next_key();
+			redraw = true;
+			if (key == Key::QUIT) {
+				// Leaves the terminal's cursor below the board
+				print_board();
+				throw End_Of_Input();
 			}
-		}
-		if (current_tile->south) {
-			if (current_tile->south->is_revealed == false) {
-				tile_reveal_recursive_func(current_tile->south);
+			if (key == Key::UP) cursor_row = max(0, cursor_row - 1);
+			else if (key == Key::DOWN) cursor_row = min(game.get_height() - 1, cursor_row + 1);
+			else if (key == Key::LEFT) cursor_col = max(0, cursor_col - 1);
+			else if (key == Key::RIGHT) cursor_col = min(game.get_width() - 1, cursor_col + 1);
+			else if (key != Key::OTHER) {
+				Move_Action action = Move_Action::REVEAL;
+				if (key == Key::FLAG) action = Move_Action::FLAG;
+				else if (key == Key::QUESTION) action = Move_Action::QUESTION;
+				else if (key == Key::CHORD) action = Move_Action::CHORD;
+				Move_Result result = make_move(game, action, cursor_row, cursor_col, before_reveal);
+				row = cursor_row;
+				col = cursor_col;
+				if (result.status == Move_Status::OK) return;
+				// Printed below the board, where the next frame starts clearing
+				print_board();
+				print_refused_move(result.status);
+				redraw = false;
 			}
+			else redraw = false;
 		}
-		if (current_tile->west) {
-			if (current_tile->west->is_revealed == false) {
-				tile_reveal_recursive_func(current_tile->west);
-			}
-		}
-		// Only reveal north, south, east, and west
-		// Do not call recursive function in directions northeast,
-		// northwest, southeast, and southwest
-	}
-
-	// EFFECTS: Returns true if arguements row and col are in bounds of
-	// the game board
-	bool valid_dimensions_chosen(int row, int col) {
-		if (row >= 0 && row < height && col >= 0 && col < width) return true;
-		return false;
 	}
 
-
 	// EFFECTS: Prints each tile on the board
-	// If the tile hasn't been revealed, tile is "?"
+	// If the tile hasn't been revealed, tile is "?" ("F" if flagged, "Q" if
+	// question marked)
 	// If the tile has been revealed, then tile is the number of nearby mines
 	// but if the number of nearby mines is 0, then tile is " "
+	// Note: Only tiles that changed since the last print are redrawn
 	void print_board(void) {
+		renderer.draw(game, false);
+	}
 
-		// Print column
-		cout << " " << " " << " ";
-		for (int col = 0; col < width; ++col) {
-			if (col < 10) cout << col << "  ";
-			else cout << col << " "; 
+	// EFFECTS: Prints the chance of a mine on each hidden tile in percent,
+	// laid out like the board. Revealed tiles are shown as they are on the board
+	void print_mine_chances(void) {
+		Mine_Probability_Map& map = *options.mine_chances;
+		map.update(game);
+		int label_width = 3;
+		for (int n = game.get_height() - 1; n >= 100; n /= 10) ++label_width;
+		// Cells fit "100" and the whole column number, with a space after
+		size_t cell_width = 4;
+		for (int n = game.get_width() - 1; n >= 1000; n /= 10) ++cell_width;
+		string text = "Chance of a mine (%)";
+		if (!map.is_exact()) text += ", estimated for the biggest groups";
+		text += "\n" + string(size_t(label_width), ' ');
+		for (int col = 0; col < game.get_width(); ++col) {
+			string label = to_string(col);
+			text += label + string(cell_width - label.size(), ' ');
 		}
-		cout << endl;
-		for (int row = 0; row < height; ++row) {
-			/*cout << row << " ";*/
-			if (row < 10) cout << row << " " << " ";
-			else cout << row << " ";
-			for (int col = 0; col < width; ++col) {
-				Tile* current_tile = Tile_at(row, col);
-				// If the tile hasn't been revealed, tile is "?"
-				if (current_tile->is_revealed == false) cout << "?" << " " << " ";
-				// If the tile has been revealed, then tile is the number of nearby mines
-				// but if the number of nearby mines is 0, then tile is " "
+		text += '\n';
+		for (int row = 0; row < game.get_height(); ++row) {
+			string label = to_string(row);
+			text += label + string(size_t(label_width) - label.size(), ' ');
+			for (int col = 0; col < game.get_width(); ++col) {
+				string cell;
+				if (game.is_revealed(row, col)) cell = game.tile_glyph(row, col, false);
 				else {
-					if (current_tile->number_of_nearby_mines == 0) cout << " " << "  ";
-					else cout << current_tile->number_of_nearby_mines << "  ";
+					// Only certain tiles show 0 or 100
+					double chance = map.mine_chance(row, col);
+					int percent = int(chance * 100 + 0.5);
+					if (chance > 1e-9) percent = max(percent, 1);
+					if (chance < 1 - 1e-9) percent = min(percent, 99);
+					cell = to_string(percent);
 				}
+				text += cell + string(cell_width - cell.size(), ' ');
 			}
-			cout << endl;
+			text += '\n';
 		}
+		cout << text;
+		// The chances are printed below the board, which can scroll the terminal
+		renderer.invalidate();
 	}
 
 	// EFFECTS: Prints board when game is either won or lost
 	// i.e. reveals entire board including mines
 	void print_board_when_game_over(void) {
+		renderer.draw(game, true);
+	}
 
-		// Print column
-		cout << " " << " " << " ";
-		for (int col = 0; col < width; ++col) {
-			if (col < 10) cout << col << "  ";
-			else cout << col << " ";
-		}
-		cout << endl;
-		for (int row = 0; row < height; ++row) {
-			if (row < 10) cout << row << " " << " ";
-			else cout << row << " ";
-			for (int col = 0; col < width; ++col) {
-				Tile* current_tile = Tile_at(row, col);
-				// If the tile has a mine, print X
-				if (current_tile->has_mine == true) cout << "X" << " " << " ";
-				else {
-					if (current_tile->number_of_nearby_mines == 0) cout << " " << "  ";
-					else cout << current_tile->number_of_nearby_mines << "  ";
-				}
-			}
-			cout << endl;
-		}
+	// EFFECTS: Prints the performance counters of the game that just ended,
+	// if the instrumentation is built in
+	void print_stats(void) {
+		if (INSTRUMENTATION_ENABLED) game_counters().print_summary(cout);
+		finish_game_counters();
 	}
 
-	// EFFECTS: Creates board based on dimensions (width and height)
-	// Each Tile is initilized to have no mine, no nearby tiles with mines, and not revealed
-	// The place_mines() function will be responsible for placing mines after
-	// make_board() is called
-	void make_board(void) {
-		// First, make the tiles in the board
-		for (size_t i = 0; i < total_number_of_tiles; ++i) {
-			board[i] = new Tile;
-		}
-		// Next, make assign directional tiles within each tile
-		for (int i = 0; i < total_number_of_tiles; ++i) {
-			Tile* temp = board[i];
-			int current_row = row_index(board[i]);
-			int current_col = column_index(board[i]);
-			// Case 1: Corner Tile Case
-			if (is_corner_tile(board[i])) {
-				// Top Left Case
-				if (row_index(temp) == 0 && column_index(temp) == 0) {
-					temp->north = nullptr;
-					temp->northeast = nullptr;
-					temp->east = Tile_at(current_row, current_col + 1);
-					temp->southeast = Tile_at(current_row + 1, current_col + 1);
-					temp->south = Tile_at(current_row + 1, current_col);
-					temp->southwest = nullptr;
-					temp->west = nullptr;
-					temp->northwest = nullptr;
-				}
-				// Top Right Case
-				else if (row_index(temp) == 0 && column_index(temp) == width - 1) {
-					temp->north = nullptr;
-					temp->northeast = nullptr;
-					temp->east = nullptr;
-					temp->southeast = nullptr;
-					temp->south = Tile_at(current_row + 1, current_col);
-					temp->southwest = Tile_at(current_row + 1, current_col - 1);
-					temp->west = Tile_at(current_row, current_col - 1);
-					temp->northwest = nullptr;
-				}
-				// Bottom Left Case
-				else if (row_index(temp) == height - 1 && column_index(temp) == 0) {
-					temp->north = Tile_at(current_row - 1, current_col);
-					temp->northeast = Tile_at(current_row - 1, current_col + 1);
-					temp->east = Tile_at(current_row, current_col + 1);
-					temp->southeast = nullptr;
-					temp->south = nullptr;
-					temp->southwest = nullptr;
-					temp->west = nullptr;
-					temp->northwest = nullptr;
-				}
-				// Bottom Right Case
-				else if (row_index(temp) == height - 1 && column_index(temp) == width - 1) {
-					temp->north = Tile_at(current_row - 1, current_col);
-					temp->northeast = nullptr;
-					temp->east = nullptr;
-					temp->southeast = nullptr;
-					temp->south = nullptr;
-					temp->southwest = nullptr;
-					temp->west = Tile_at(current_row, current_col - 1);
-					temp->northwest = Tile_at(current_row - 1, current_col - 1);
-				}
-				// For debugging purposes
-				else assert(false);
-			}
-			// Case 2: Edge Tile Case (NOT Corner Tile)
-			else if (is_edge_tile(board[i])) {
-				// Top Case
-				if (row_index(temp) == 0) {
-					temp->north = nullptr;
-					temp->northeast = nullptr;
-					temp->east = Tile_at(current_row, current_col + 1);
-					temp->southeast = Tile_at(current_row + 1, current_col + 1);
-					temp->south = Tile_at(current_row + 1, current_col);
-					temp->southwest = Tile_at(current_row + 1, current_col - 1);
-					temp->west = Tile_at(current_row, current_col - 1);
-					temp->northwest = nullptr;
-				}
-				// Left Case
-				else if (column_index(temp) == 0) {
-					temp->north = Tile_at(current_row - 1, current_col);
-					temp->northeast = Tile_at(current_row - 1, current_col + 1);
-					temp->east = Tile_at(current_row, current_col + 1);
-					temp->southeast = Tile_at(current_row + 1, current_col + 1);
-					temp->south = Tile_at(current_row + 1, current_col);
-					temp->southwest = nullptr;
-					temp->west = nullptr;
-					temp->northwest = nullptr;
-				}
-				// Right Case
-				else if (column_index(temp) == width - 1) {
-					temp->north = Tile_at(current_row - 1, current_col);
-					temp->northeast = nullptr;
-					temp->east = nullptr;
-					temp->southeast = nullptr;
-					temp->south = Tile_at(current_row + 1, current_col);
-					temp->southwest = Tile_at(current_row + 1, current_col - 1);
-					temp->west = Tile_at(current_row, current_col - 1);
-					temp->northwest = Tile_at(current_row - 1, current_col - 1);
-				}
-				// Bottom Case
-				else if (row_index(temp) == height - 1) {
-					temp->north = Tile_at(current_row - 1, current_col);
-					temp->northeast = Tile_at(current_row - 1, current_col + 1);
-					temp->east = Tile_at(current_row, current_col + 1);
-					temp->southeast = nullptr;
-					temp->south = nullptr;
-					temp->southwest = nullptr;
-					temp->west = Tile_at(current_row, current_col - 1);
-					temp->northwest = Tile_at(current_row - 1, current_col - 1);
-				}
-				// For debugging purposes
-				else assert(false);
-			}
-			// Case 3: Middle Tile Case
-			else {
-				temp->north = Tile_at(current_row - 1, current_col);
-				temp->northeast = Tile_at(current_row - 1, current_col + 1);
-				temp->east = Tile_at(current_row, current_col + 1);
-				temp->southeast = Tile_at(current_row + 1, current_col + 1);
-				temp->south = Tile_at(current_row + 1, current_col);
-				temp->southwest = Tile_at(current_row + 1, current_col - 1);
-				temp->west = Tile_at(current_row, current_col - 1);
-				temp->northwest = Tile_at(current_row - 1, current_col - 1);
-			}
-		}
-		// Upon making board, all tiles initially have no mines and is not revealed
-		// We will call another function when randomly placing the mines
-		for (size_t i = 0; i < total_number_of_tiles; ++i) {
-			board[i]->has_mine = false;
-			board[i]->is_revealed = false;
-			board[i]->number_of_nearby_mines = 0;
-		}
+	// EFFECTS: Saves a snapshot of the game if a save file was given
+	// Note: Nothing is saved until the mines are placed. A snapshot is the
+	// whole board, so it is only saved when a game ends or the input does,
+	// not after every move
+	void save(void) {
+		if (!options.save_path.empty() && game.mines_placed()) save_snapshot(game, options.save_path);
 	}
-	// EFFECTS: Returns a random integer in range [0, x] inclusive
-	int random_0_to_x(int x) const {
-		std::random_device dev;
-		std::mt19937 rng(dev());
-		std::uniform_int_distribution<std::mt19937::result_type> distribution_obj(0, x); // distribution in range [0, x]
-		// ^^^ Change as needed ^^^
-		return distribution_obj(rng);
-	}
-
-	// EFFECTS: Randomly places mines on the board
-	void place_mines(void) {
-		// We can edit this function as we're developing it
-		int mines_placed = 0;
-		while (mines_placed != number_of_mines) {
-			int x = random_0_to_x(total_number_of_tiles - 1);
-			// Look first if tile already has a mine, if so skip it
-			if (board[x]->has_mine) {
-				continue;
-			}
-			board[x]->has_mine = true;
-			++mines_placed;
-		}
-		// Update the number of nearby mines for each tile
-		for (size_t i = 0; i < total_number_of_tiles; ++i) {
-			look_for_mines_nearby(board[i]);
+
+	// REQUIRES: options.generator isn't null and no mines are placed yet
+	// EFFECTS: Changes the seed of the game to one whose board can be cleared
+	// without guessing when the first tile picked is at row and col
+	void choose_no_guess_board(int row, int col) {
+		No_Guess_Result result = options.generator->find_seed(game.get_seed(), row, col);
+		if (!result.found) {
+			cout << "No board without guesses found, playing a random board" << endl;
+			return;
 		}
-		// Uncomment for debugging purposes
-		//reveal_mines();
-	}
-	// EFFECTS: Given a Tile pointer, looks for mines nearby the current tile
-	// and calculates number of nearby mines around the current tile
-	void look_for_mines_nearby(Tile* current_tile) {
-		int x = 0;
-		if (current_tile->north) if (current_tile->north->has_mine) ++x;
-		if (current_tile->northeast) if (current_tile->northeast->has_mine) ++x;
-		if (current_tile->east) if (current_tile->east->has_mine) ++x;
-		if (current_tile->southeast) if (current_tile->southeast->has_mine) ++x;
-		if (current_tile->south) if (current_tile->south->has_mine) ++x;
-		if (current_tile->southwest) if (current_tile->southwest->has_mine) ++x;
-		if (current_tile->west) if (current_tile->west->has_mine) ++x;
-		if (current_tile->northwest) if (current_tile->northwest->has_mine) ++x;
-
-		current_tile->number_of_nearby_mines = x;
-	}
-	// EFFECTS: Returns true if tile is a corner tile
-	bool is_corner_tile(Tile* temp) const {
-		if((row_index(temp) == 0 && column_index(temp) == 0) ||
-		   (row_index(temp) == 0 && column_index(temp) == width - 1) ||
-		   (row_index(temp) == height - 1 && column_index(temp) == 0) ||
-		   (row_index(temp) == height - 1 && column_index(temp) == width - 1)) return true;
-		return false;
-	}
-
-	// EFFECTS: Returns true if tile is an edge tile and not a
-	// corner tile
-	bool is_edge_tile(Tile* temp) const {
-		// Note: Edge NOT Corner
-		if (is_corner_tile(temp)) return false;
-		else if (row_index(temp) == 0 || column_index(temp) == 0 ||
-			column_index(temp) == width - 1 || row_index(temp) == height - 1) return true;
-		else return false;
-	}
-
-	// EFFECTS: Returns pointer to tile given row and column
-	Tile* Tile_at(int row, int col) {
-		return board[row * width + col];
-	}
-
-	// EFFECTS: Given row and column indexes, returns tile index
-	// Example, if board is 10x10:
-	// Row 0 Col 0 = Tile 0
-	// Row 0 Col 5 = Tile 5
-	// Row 9 Col 9 = Tile 99
-	int tile_index(int row, int col) {
-		return row * width + col;
-	}
-
-	// EFFECTS: Returns row index given pointer to tile
-	// Note: row_index function is O(n) (this is super slow)
-	int row_index(Tile* tile_ptr) const {
-
-		Tile** temp = board_start;
-		while (*temp != tile_ptr) ++temp;
-
-		int board_index = temp - board_start;
-		int row = (board_index - column_index(tile_ptr)) / width;
-		return row; 
-	}
-
-	// EFFECTS: Returns column index given pointer to tile
-	// Note: column_index function is O(n) (this is super slow)
-	int column_index(Tile* tile_ptr) const {
-		Tile** temp = board_start;
-		while (*temp != tile_ptr) ++temp;
-
-		int board_index = temp - board_start;
-		int column = board_index % width;
-		return column;
+		game.set_seed(result.seed);
+		cout << "No-guess board found after " << result.candidates << " boards in "
+			<< result.seconds * 1000 << " ms (seed " << result.seed << ")" << endl;
 	}
 };
 
+// EFFECTS: Plays number_of_games games in the terminal, one after another
+void play_in_console(Minesweeper_Game& game, const Console_Options& options,
+	uint64_t number_of_games) {
+	Minesweeper_Console console(game, options);
+	console.run_games(number_of_games, false);
+}
+
+// EFFECTS: Plays number_of_games games with the solver, one after another,
+// and prints how each went
+void autoplay_in_console(Minesweeper_Game& game, const Console_Options& options,
+	uint64_t number_of_games) {
+	Minesweeper_Console console(game, options);
+	console.run_games(number_of_games, true);
+}
+
+// EFFECTS: Plays a game on a chunked board in the terminal. Only the part of
+// the board around the last tile picked is drawn, starting from the middle
+void play_chunked_in_console(Chunked_Minesweeper_Game& game, Command_Reader& commands) {
+	cout << "Seed: " << game.get_seed() << endl;
+	cout << "Board: " << game.get_width() << "x" << game.get_height() << ", "
+		<< game.get_number_of_mines() << " mines" << endl;
+	game.start_game();
+	Board_Renderer renderer;
+	renderer.set_plain_window(20, 20);
+	renderer.set_focus(game.get_height() / 2, game.get_width() / 2);
+	while (game.state() == Game_State::IN_PROGRESS) {
+		renderer.draw(game, false);
+		int row_chosen, column_chosen;
+		read_and_reveal_tile(game, commands, row_chosen, column_chosen);
+		renderer.set_focus(row_chosen, column_chosen);
+	}
+	renderer.draw(game, true);
+	if (game.state() == Game_State::LOST) cout << "Game Over! Hit Mine!" << endl;
+	else cout << "You Won!" << endl;
+	cout << "Chunks made: " << game.number_of_chunks_made() << " (" << game.resident_chunks()
+		<< " in memory, " << game.stored_chunks() << " stored)" << endl;
+	if (INSTRUMENTATION_ENABLED) game_counters().print_summary(cout);
+	finish_game_counters();
+}
+
+// EFFECTS: Writes the performance counters of every game played to the file
+// at path as JSON
+void write_stats(const string& path) {
+	if (!INSTRUMENTATION_ENABLED) {
+		cout << "Built without MINESWEEPER_INSTRUMENT, no stats written" << endl;
+		return;
+	}
+	ofstream file(path);
+	total_counters().print_json(file);
+	if (!file) cout << "Error: Could not write stats to " << path << endl;
+}
+
+// EFFECTS: Replays every move log in paths through the engine, checks each
+// one ends the way it says, and prints how quickly the moves were made
+// Returns true if every log replayed the same way
+bool replay_logs(const vector<string>& paths) {
+	uint64_t total_moves = 0;
+	double total_seconds = 0;
+	bool all_ok = true;
+	for (const string& path : paths) {
+		Replay_Results results = replay_move_log(path);
+		cout << path << ": " << results.moves << " moves, ";
+		if (!results.moves_valid) cout << "move " << results.moves << " was refused";
+		else if (!results.has_final_state) cout << "no final state to check";
+		else if (results.final_state_matches) cout << "final state matches";
+		else cout << "final state DOES NOT MATCH";
+		cout << endl;
+		total_moves += results.moves;
+		total_seconds += results.seconds;
+		all_ok = all_ok && results.ok();
+	}
+	cout << "Moves replayed: " << total_moves << endl;
+	cout << "Moves per second: " << (total_seconds > 0 ? total_moves / total_seconds : 0) << endl;
+	return all_ok;
+}
+
+// EFFECTS: Plays number_of_games games with the same settings as game on
+// number_of_threads threads and prints the totals
+// player is "solver" or "random"
+// Note: Uses game's first click safe setting too
+void run_batch(const Minesweeper_Game& game, uint64_t number_of_games,
+	unsigned number_of_threads, const string& player) {
+	Simulation_Config config;
+	config.width = game.get_width();
+	config.height = game.get_height();
+	config.number_of_mines = game.get_number_of_mines();
+	config.number_of_games = number_of_games;
+	config.base_seed = game.get_seed();
+	config.first_click_safe = game.is_first_click_safe();
+
+	Thread_Pool pool(number_of_threads);
+	Simulation_Results results;
+	auto simulate = [&](auto board_type) {
+		typedef typename decltype(board_type)::type Board;
+		if (player == "random") results = run_simulation<Random_Player, Board>(config, pool);
+		else if (player == "solver") results = run_simulation<Minesweeper_Solver, Board>(config, pool);
+		else throw Invalid_Arguements();
+	};
+	// The classic boards are played on their Fixed_Board, which gives the same results
+	bool fixed = with_fixed_board(config.width, config.height, config.number_of_mines, simulate);
+	if (!fixed) simulate(Board_Type<Minesweeper_Game>());
+
+	cout << "Board: " << config.width << "x" << config.height << ", "
+		<< config.number_of_mines << " mines" << (fixed ? " (fixed size)" : "") << endl;
+	cout << "Seed: " << config.base_seed << endl;
+	cout << "Player: " << player << endl;
+	cout << "Threads: " << pool.size() << endl;
+	cout << "Games: " << results.games << endl;
+	cout << "Wins: " << results.wins << " (" << results.win_rate() * 100 << "%)" << endl;
+	cout << "Moves per game: " << double(results.moves) / results.games << endl;
+	cout << "Tiles revealed per game: " << double(results.tiles_revealed) / results.games << endl;
+	cout << "Games per second: " << results.games_per_second() << endl;
+	cout << "Checksum: " << results.checksum << endl;
+}
+
+// Server stopped by SIGINT and SIGTERM
+Game_Server* running_server = nullptr;
+
+// EFFECTS: Stops the running server
+void stop_server(int) {
+	if (running_server) running_server->stop();
+}
+
+// EFFECTS: Hosts games for clients at address until interrupted, then
+// prints the totals
+void serve(const string& address) {
+	raise_open_file_limit();
+	Game_Server server(address);
+	running_server = &server;
+	signal(SIGINT, stop_server);
+	signal(SIGTERM, stop_server);
+	cout << "Listening on " << address << endl;
+	server.run();
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+	running_server = nullptr;
+	const Server_Statistics& stats = server.statistics();
+	cout << "Connections: " << stats.connections << endl;
+	cout << "Games: " << stats.games << endl;
+	cout << "Moves: " << stats.moves << endl;
+	cout << "Deltas sent: " << stats.deltas << endl;
+	cout << "Bytes sent: " << stats.bytes_sent << endl;
+}
+
+// EFFECTS: Returns new game made with the constructor that matches args
+// No arguements: default constructor. Width and height: second constructor.
+// Width, height, and number of mines: third constructor
+unique_ptr<Minesweeper_Game> make_game(const vector<string>& args) {
+	// If there are no other arguements, then use default constructor
+	if (args.size() == 0) {
+		return unique_ptr<Minesweeper_Game>(new Minesweeper_Game);
+	}
+	// If width and height are given, then use second custom constuctor
+	else if (args.size() == 2) {
+		int width = atoi(args[0].c_str());
+		int height = atoi(args[1].c_str());
+		return unique_ptr<Minesweeper_Game>(new Minesweeper_Game(width, height));
+	}
+	// If number of mines is also given, then use third custom constructor
+	else if (args.size() == 3) {
+		int width = atoi(args[0].c_str());
+		int height = atoi(args[1].c_str());
+		int number_of_mines = atoi(args[2].c_str());
+		return unique_ptr<Minesweeper_Game>(new Minesweeper_Game(width, height, number_of_mines));
+	}
+	Invalid_Arguements error_instance1;
+	throw error_instance1;
+}
 
 // Main function
 int main(int argc, char** argv) {
-	
+
 	try {
-		// Arguements: exec, width, height, number of mines
+		// Arguements: exec, [options], width, height, number of mines
+		// "--seed N" places the mines the same way every time N is used
+		// "--autoplay" lets the solver play the game
+		// "--batch N" plays N games without the terminal instead. "--threads N"
+		// sets how many threads it uses, "--player solver|random" who plays
+		// "--load FILE" carries on the game saved in snapshot FILE instead of
+		// starting a new board, "--save FILE" saves a snapshot when the game
+		// ends or the input does (or the player quits)
+		// "--record FILE" logs every move, "--replay FILE" (any number of
+		// times) replays logs through the engine and checks how they end
+		// "--chunked" plays on a board made a chunk at a time as it is needed,
+		// with "--density P" percent mines (12 to 90, default 15) and at most
+		// "--chunks N" chunks in memory (default 4096). Only width and
+		// height are given (default 1000000 by 1000000)
+		// "--safe-start" keeps the first tile picked and the tiles around it
+		// clear of mines. "--no-guess" also picks a board that can be cleared
+		// from there without guessing, searching on "--threads N" threads
+		// "--stats FILE" writes the performance counters as JSON at exit (if
+		// built with MINESWEEPER_INSTRUMENT)
+		// "--games N" plays N games one after another (default 1), with a new
+		// seed for each game after the first
+		// "--heatmap" shows the chance of a mine on every hidden tile under
+		// the board, worked out on "--threads N" threads
+		// "--preset beginner|intermediate|expert" plays a classic board (9x9
+		// with 10 mines, 16x16 with 40, or 30x16 with 99) instead of giving
+		// the width, height, and number of mines
+		// "--script FILE" reads the moves from FILE instead of the terminal,
+		// one per line like "r 3 4" (see Command_Reader). "--cursor" picks
+		// tiles with the arrow keys on the board instead of typing them
+		// "--serve ADDRESS" hosts games for clients on a port on 127.0.0.1 or
+		// a Unix socket path (see server_protocol.h) until interrupted
+		vector<string> args;
+		bool seed_given = false;
+		uint64_t seed = 0;
+		uint64_t batch_games = 0;
+		uint64_t console_games = 1;
+		unsigned threads = thread::hardware_concurrency();
+		string player = "solver";
+		bool autoplay = false;
+		string load_path;
+		string save_path;
+		string record_path;
+		vector<string> replay_paths;
+		bool chunked = false;
+		bool safe_start = false;
+		bool no_guess = false;
+		bool heatmap = false;
+		string stats_path;
+		string serve_address;
+		string preset_name;
+		string script_path;
+		bool cursor = false;
+		int density = 15;
+		size_t max_chunks = 4096;
+		for (int i = 1; i < argc; ++i) {
+			string arg = argv[i];
+			bool has_value = i + 1 < argc;
+			if (arg == "--seed" && has_value) {
+				seed = strtoull(argv[++i], nullptr, 10);
+				seed_given = true;
+			}
+			else if (arg == "--batch" && has_value) batch_games = strtoull(argv[++i], nullptr, 10);
+			else if (arg == "--games" && has_value) console_games = strtoull(argv[++i], nullptr, 10);
+			else if (arg == "--threads" && has_value) threads = unsigned(atoi(argv[++i]));
+			else if (arg == "--player" && has_value) player = argv[++i];
+			else if (arg == "--autoplay") autoplay = true;
+			else if (arg == "--load" && has_value) load_path = argv[++i];
+			else if (arg == "--save" && has_value) save_path = argv[++i];
+			else if (arg == "--record" && has_value) record_path = argv[++i];
+			else if (arg == "--replay" && has_value) replay_paths.push_back(argv[++i]);
+			else if (arg == "--chunked") chunked = true;
+			else if (arg == "--safe-start") safe_start = true;
+			else if (arg == "--no-guess") no_guess = true;
+			else if (arg == "--heatmap") heatmap = true;
+			else if (arg == "--density" && has_value) density = atoi(argv[++i]);
+			else if (arg == "--chunks" && has_value) max_chunks = size_t(strtoull(argv[++i], nullptr, 10));
+			else if (arg == "--stats" && has_value) stats_path = argv[++i];
+			else if (arg == "--serve" && has_value) serve_address = argv[++i];
+			else if (arg == "--preset" && has_value) preset_name = argv[++i];
+			else if (arg == "--script" && has_value) script_path = argv[++i];
+			else if (arg == "--cursor") cursor = true;
+			else if (arg.compare(0, 2, "--") == 0) throw Invalid_Arguements();
+			else args.push_back(arg);
+		}
+
+		if (!preset_name.empty()) {
+			const Board_Preset* preset = find_preset(preset_name);
+			if (!preset || !args.empty()) throw Invalid_Arguements();
+			args.push_back(to_string(preset->width));
+			args.push_back(to_string(preset->height));
+			args.push_back(to_string(preset->number_of_mines));
+		}
 
-		// If argc == 1, then use default constructor
-		if (argc == 1) {
-			Minesweeper_Game inst1;
-			inst1.run_game();
+		if (!serve_address.empty()) {
+			// Clients pick the boards
+			if (!args.empty()) throw Invalid_Arguements();
+			serve(serve_address);
+			return 0;
 		}
-		// If argc == 3, then use second custom constuctor
-		else if (argc == 3) {
-			int width = atoi(argv[1]);
-			int height = atoi(argv[2]);
-			Minesweeper_Game inst2(width, height);
-			inst2.run_game();
+
+		if (!replay_paths.empty()) {
+			// The logs have the dimensions, mines, and seed
+			if (!args.empty()) throw Invalid_Arguements();
+			return replay_logs(replay_paths) ? 0 : 1;
 		}
-		// If argc == 4, then use third custom constructor
-		else if (argc == 4) {
-			int width = atoi(argv[1]);
-			int height = atoi(argv[2]);
-			int number_of_mines = atoi(argv[3]);
-			Minesweeper_Game inst3(width, height, number_of_mines);
-			inst3.run_game();
+
+		// Keys are read straight from a terminal, which must show the board too
+		if (cursor && (!script_path.empty() || autoplay || batch_games > 0 || chunked || heatmap
+			|| !isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO))) {
+			throw Invalid_Arguements();
 		}
-		else {
-			Invalid_Arguements error_instance1;
-			throw error_instance1;
+		unique_ptr<Line_Reader> input(script_path.empty() ? new Line_Reader(STDIN_FILENO)
+			: new Line_Reader(script_path));
+		Command_Reader commands(*input);
+
+		if (chunked) {
+			// Only a game in the terminal can be played on a chunked board
+			if (batch_games > 0 || autoplay || !load_path.empty() || !save_path.empty()
+				|| !record_path.empty() || safe_start || no_guess || console_games != 1 || heatmap
+				|| (args.size() != 0 && args.size() != 2)) {
+				throw Invalid_Arguements();
+			}
+			int width = args.empty() ? 1000000 : atoi(args[0].c_str());
+			int height = args.empty() ? 1000000 : atoi(args[1].c_str());
+			Chunked_Minesweeper_Game game(width, height, density, max_chunks);
+			if (seed_given) game.set_seed(seed);
+			play_chunked_in_console(game, commands);
+			if (!stats_path.empty()) write_stats(stats_path);
+			return 0;
+		}
+
+		// Every check is made before anything is opened for writing
+		// No-guess boards are searched for one at a time, not for batches
+		if (no_guess && batch_games > 0) throw Invalid_Arguements();
+		// The solver doesn't read moves
+		if (!script_path.empty() && (batch_games > 0 || autoplay)) throw Invalid_Arguements();
+		// The chances are only shown to a player in the terminal
+		if (heatmap && (batch_games > 0 || autoplay)) throw Invalid_Arguements();
+		// Batches aren't logged
+		if (!record_path.empty() && batch_games > 0) throw Invalid_Arguements();
+		// A loaded snapshot or a move log only covers one game
+		if (console_games == 0 || (console_games != 1 && (!load_path.empty() || !record_path.empty()
+			|| batch_games > 0))) {
+			throw Invalid_Arguements();
+		}
+
+		Console_Options options;
+		options.board_ready = !load_path.empty();
+		options.save_path = save_path;
+		options.commands = &commands;
+		// A script plays at the speed it is read, so only the end of each game is drawn
+		options.draw_every_move = script_path.empty();
+		unique_ptr<Key_Reader> keys;
+		if (cursor) {
+			keys.reset(new Key_Reader(STDIN_FILENO));
+			options.keys = keys.get();
+		}
+		unique_ptr<Minesweeper_Game> game;
+		if (options.board_ready) {
+			// The snapshot has the dimensions, mines, and seed. A log replays
+			// from a fresh board, so it can't start from a snapshot. Its mines
+			// are already placed, so the first click can't be made safe either
+			if (!args.empty() || seed_given || !record_path.empty()) throw Invalid_Arguements();
+			if (safe_start || no_guess) throw Invalid_Arguements();
+			game = load_snapshot(load_path);
+		}
+		else game = make_game(args);
+		if (seed_given) game->set_seed(seed);
+		if (!options.board_ready) game->set_first_click_safe(safe_start || no_guess);
+		unique_ptr<Thread_Pool> pool;
+		if (no_guess || heatmap) pool.reset(new Thread_Pool(threads));
+		unique_ptr<No_Guess_Generator> generator;
+		if (no_guess) {
+			generator.reset(new No_Guess_Generator(game->get_width(), game->get_height(),
+				game->get_number_of_mines(), *pool));
+			options.generator = generator.get();
+		}
+		unique_ptr<Mine_Probability_Map> mine_chances;
+		if (heatmap) {
+			mine_chances.reset(new Mine_Probability_Map(pool.get()));
+			options.mine_chances = mine_chances.get();
 		}
+		// Made last, since opening the log empties the file
+		unique_ptr<Move_Log_Writer> log;
+		if (!record_path.empty()) {
+			log.reset(new Move_Log_Writer(record_path));
+			options.log = log.get();
+		}
+		if (batch_games > 0) run_batch(*game, batch_games, threads, player);
+		else if (autoplay) autoplay_in_console(*game, options, console_games);
+		else play_in_console(*game, options, console_games);
+		if (!stats_path.empty()) write_stats(stats_path);
 	}
 	catch (const Invalid_Arguements &obj3) {
 			cout << "Invalid arguements" << endl;
+		return 1;
+	}
+	catch (const Improper_Dimensions& obj_1) {
+		cout << "Error: Improper dimensions. Ending program." << endl;
+		return 1;
+	}
+	catch (const Improper_Number_of_Mines& obj_2) {
+		cout << "Error: Improper number of mines: Ending program." << endl;
+		return 1;
+	}
+	catch (const Snapshot_File_Error& obj_4) {
+		cout << "Error: Could not read or write snapshot file. Ending program." << endl;
+		return 1;
+	}
+	catch (const Invalid_Snapshot& obj_5) {
+		cout << "Error: Invalid snapshot file. Ending program." << endl;
+		return 1;
+	}
+	catch (const Move_Log_File_Error& obj_6) {
+		cout << "Error: Could not read or write move log. Ending program." << endl;
+		return 1;
+	}
+	catch (const Invalid_Move_Log& obj_7) {
+		cout << "Error: Invalid move log. Ending program." << endl;
+		return 1;
+	}
+	catch (const Server_Error& obj_8) {
+		cout << "Error: Could not run the server. Ending program." << endl;
+		return 1;
+	}
+	catch (const Input_File_Error& obj_9) {
+		cout << "Error: Could not read the moves. Ending program." << endl;
+		return 1;
+	}
+	catch (const End_Of_Input& obj_10) {
+		cout << "Input ended before the game did. Ending program." << endl;
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,816 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef MINESWEEPER_GAME_H
+#define MINESWEEPER_GAME_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "instrumentation.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Exceptions
+class Improper_Dimensions {};
+class Improper_Number_of_Mines {};
+
+// State of a game
+enum class Game_State {
+	IN_PROGRESS,	// Game is still being played
+	WON,			// Every tile without a mine has been revealed
+	LOST			// A tile with a mine has been revealed
+};
+
+// What happened when a move was made
+enum class Move_Status {
+	OK,					// Move was made
+	OUT_OF_BOUNDS,		// Row or column is not on the board
+	ALREADY_REVEALED,	// Tile has already been revealed
+	FLAGGED,			// Tile is flagged, so it can't be revealed
+	NOT_REVEALED,		// Tile hasn't been revealed, so it can't be chorded
+	WRONG_NUMBER_OF_FLAGS,	// Number of flags around the tile isn't its number
+						// of nearby mines, so it can't be chorded
+	GAME_OVER			// Game has already been won or lost
+};
+
+// Kind of move
+enum class Move_Action {
+	REVEAL,		// reveal()
+	FLAG,		// flag()
+	QUESTION,	// question()
+	CHORD		// chord()
+};
+
+// What the player can see of a tile
+// A hidden tile can be flagged or question marked, and flag() and question()
+// move it between those three states. Once revealed, it stays revealed.
+enum class Tile_State {
+	HIDDEN,
+	FLAGGED,	// Player thinks it has a mine
+	QUESTIONED,	// Player isn't sure
+	REVEALED
+};
+
+// A move that was made
+struct Move {
+	int row;
+	int col;
+	Move_Action action;
+};
+
+// Result of a move
+struct Move_Result {
+	Move_Status status;
+	Game_State state;		// State of the game after the move
+	size_t tiles_revealed;	// Number of tiles the move revealed
+};
+
+// EFFECTS: Mixes x into a well spread 64-bit number (SplitMix64 finalizer)
+inline uint64_t mix_64(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+// EFFECTS: Returns a random integer in range [0, x] inclusive drawn from rng
+// Note: Doesn't use std::uniform_int_distribution, so the same seed gives the
+// same numbers on every platform and standard library
+inline uint64_t random_0_to_x(std::mt19937_64& rng, uint64_t x) {
+	if (x == UINT64_MAX) return rng();
+	uint64_t range = x + 1;
+	// Reject the lowest (2^64 % range) values so every result is equally likely
+	uint64_t threshold = (0 - range) % range;
+	uint64_t r = rng();
+	while (r < threshold) r = rng();
+	return r % range;
+}
+
+// Minesweeper Class
+// The game itself, with no input or output. Moves are made with reveal(),
+// flag(), question(), and chord(), and the board can be looked at through state(), is_revealed(),
+// number_of_nearby_mines(), and friends. See minesweeper.cpp for the game
+// played in the terminal.
+class Minesweeper_Game {
+private:
+	// Each tile is packed into a single byte:
+	//   bits 0-3: number of nearby mines in all directions (0-8)
+	//             N, NE, E, SE, S, SW, W, NW
+	//   bit 4:    tile contains a mine
+	//   bit 5:    tile has been revealed
+	//   bit 6:    tile has been flagged
+	//   bit 7:    tile has been question marked
+	// At most one of bits 5-7 is set, see Tile_State
+	typedef unsigned char Tile;
+	static const Tile NEARBY_MINES_MASK = 0x0F;
+	static const Tile MINE = 0x10;
+	static const Tile REVEALED = 0x20;
+	static const Tile FLAGGED = 0x40;
+	static const Tile QUESTIONED = 0x80;
+
+	// board[] is one contiguous grid of (height + 2) rows by (width + 2)
+	// columns. The extra row/column on every side is a border of tiles that
+	// are already revealed and never hold a mine, so the neighbours of any
+	// tile on the board can be found by index arithmetic without bounds checks.
+	// A tile is identified by its index into board[].
+	std::vector<Tile> board;
+	int width;
+	int height;
+	size_t stride;	// Number of tiles in one row of board[] (width + 2)
+	size_t total_number_of_tiles;
+	int number_of_mines;
+	size_t unrevealed_safe_tiles;	// Tiles without a mine that are not yet revealed
+	size_t revealed_mines;	// Mines revealed, the game is lost if there are any
+	bool first_click_safe;	// Mines are placed on the first reveal, away from it
+	bool mines_are_placed;
+	uint64_t seed;			// Seed used to place the mines
+	std::mt19937_64 rng;	// One random number generator for the whole game
+	Move previous_move;		// Last move that was made, for move logs
+
+	// Index offsets to the neighbours of a tile: N, NE, E, SE, S, SW, W, NW
+	ptrdiff_t neighbour_offsets[8];
+
+	// Tiles revealed by the most recent call to tile_reveal_func()
+	// Also used as its work queue
+	std::vector<size_t> revealed_tiles;
+
+public:
+
+	// Default Constructor (14x18 board with 40 mines)
+	Minesweeper_Game() : Minesweeper_Game(14, 18, 40) {}
+
+	// Custom Constructor: Specify width and height. Number of mines default 20
+	Minesweeper_Game(int width_in, int height_in) :
+		Minesweeper_Game(width_in, height_in, 20) {}
+
+	// Custom Constructor: Specify width, height, and number of mines
+	// Throws Improper_Dimensions or Improper_Number_of_Mines if they don't
+	// make a playable board
+	Minesweeper_Game(int width_in, int height_in, int number_of_mines_in) :
+		width(width_in), height(height_in), stride(size_t(width_in) + 2),
+		total_number_of_tiles(size_t(width_in) * size_t(height_in)),
+		number_of_mines(number_of_mines_in), unrevealed_safe_tiles(0),
+		revealed_mines(0), first_click_safe(false), mines_are_placed(false), previous_move{0, 0, Move_Action::REVEAL} {
+		if (width_in <= 1 || height_in <= 1) throw Improper_Dimensions();
+		if (number_of_mines_in <= 0 || size_t(number_of_mines_in) > total_number_of_tiles) {
+			throw Improper_Number_of_Mines();
+		}
+		unrevealed_safe_tiles = total_number_of_tiles - number_of_mines;
+		set_seed(random_seed());
+		set_neighbour_offsets();
+	}
+
+	// EFFECTS: Seeds the random number generator used to place mines
+	// The same seed and board dimensions always give the same board
+	void set_seed(uint64_t seed_in) {
+		seed = seed_in;
+		rng.seed(seed_in);
+	}
+
+	// EFFECTS: Returns seed used to place the mines
+	uint64_t get_seed(void) const {
+		return seed;
+	}
+
+	// EFFECTS: Returns a seed taken from the operating system's entropy source
+	static uint64_t random_seed(void) {
+		std::random_device dev;
+		return (uint64_t(dev()) << 32) | dev();
+	}
+
+	// EFFECTS: If on, start_game() leaves the mines out and the first reveal
+	// places them, keeping the tile revealed and (if there's room) the tiles
+	// around it clear. See place_mines_avoiding()
+	void set_first_click_safe(bool on) {
+		first_click_safe = on;
+	}
+
+	// EFFECTS: Returns true if the first reveal can't hit a mine
+	bool is_first_click_safe(void) const {
+		return first_click_safe;
+	}
+
+	// EFFECTS: Returns true once the mines of the current game are on the board
+	bool mines_placed(void) const {
+		return mines_are_placed;
+	}
+
+	// EFFECTS: Makes the board and places the mines, ready for the first move
+	// (unless the first click is safe, then the first move places them)
+	void start_game(void) {
+		make_board();
+		if (!first_click_safe) place_mines();
+	}
+
+	// EFFECTS: Starts a new game on the same board with seed_in, like
+	// set_seed() then start_game()
+	// Note: The board and the reveal queue keep their memory from one game to
+	// the next, so games after the first make no allocations (on boards of
+	// more than 4096 tiles, once the queue has grown to fit the biggest reveal)
+	void new_game(uint64_t seed_in) {
+		set_seed(seed_in);
+		start_game();
+	}
+
+	// EFFECTS: Reveals the tile at row and col. If it has a mine, the game is
+	// lost. Otherwise the tiles around it are revealed too (see
+	// tile_reveal_func()), and the game is won once every tile without a mine
+	// has been revealed. Question marked tiles can be revealed, flagged ones
+	// can't.
+	Move_Result reveal(int row, int col) {
+		MINESWEEPER_TIME_STAGE(Stage::MOVE);
+		Move_Status status = check_move(row, col);
+		if (status != Move_Status::OK) return Move_Result{status, state(), 0};
+		size_t tile_chosen = Tile_at(row, col);
+		if (board[tile_chosen] & FLAGGED) return Move_Result{Move_Status::FLAGGED, state(), 0};
+		previous_move = Move{row, col, Move_Action::REVEAL};
+		if (!mines_are_placed) place_mines_avoiding(row, col);
+
+		// Check if tile is a mine, if so then game over
+		if (board[tile_chosen] & MINE) {
+			board[tile_chosen] |= REVEALED;
+			revealed_tiles.clear();
+			revealed_tiles.push_back(tile_chosen);
+			++revealed_mines;
+			return Move_Result{Move_Status::OK, Game_State::LOST, 1};
+		}
+
+		// Then reveal tile_chosen and the tiles around it
+		// This also updates the count of unrevealed safe tiles for check_if_win()
+		size_t tiles_revealed = tile_reveal_func(tile_chosen);
+		return Move_Result{Move_Status::OK, state(), tiles_revealed};
+	}
+
+	// EFFECTS: Flags the tile at row and col if it isn't flagged (replacing
+	// a question mark), otherwise removes the flag. Flagged tiles can't be
+	// revealed.
+	Move_Result flag(int row, int col) {
+		return mark(row, col, FLAGGED, Move_Action::FLAG);
+	}
+
+	// EFFECTS: Question marks the tile at row and col if it isn't question
+	// marked (replacing a flag), otherwise removes the question mark
+	// Question marks are only for the player, they don't change any rules.
+	Move_Result question(int row, int col) {
+		return mark(row, col, QUESTIONED, Move_Action::QUESTION);
+	}
+
+	// EFFECTS: Chords the revealed tile at row and col: if as many of its
+	// neighbours are flagged as it has nearby mines, reveals every neighbour
+	// that isn't flagged, and the tiles around those like reveal() does. If a
+	// flag was wrong, the mines next to the tile are revealed too and the
+	// game is lost.
+	// Note: All the neighbours go through one pass of tile_reveal_func()
+	// together, so a chord costs no more than a single reveal
+	Move_Result chord(int row, int col) {
+		MINESWEEPER_TIME_STAGE(Stage::MOVE);
+		if (state() != Game_State::IN_PROGRESS) return Move_Result{Move_Status::GAME_OVER, state(), 0};
+		if (!valid_dimensions_chosen(row, col)) return Move_Result{Move_Status::OUT_OF_BOUNDS, state(), 0};
+		size_t tile_chosen = Tile_at(row, col);
+		if (!(board[tile_chosen] & REVEALED)) return Move_Result{Move_Status::NOT_REVEALED, state(), 0};
+		int flags = 0;
+		for (int i = 0; i < 8; ++i) {
+			if (board[tile_chosen + neighbour_offsets[i]] & FLAGGED) ++flags;
+		}
+		if (flags != (board[tile_chosen] & NEARBY_MINES_MASK)) {
+			return Move_Result{Move_Status::WRONG_NUMBER_OF_FLAGS, state(), 0};
+		}
+		previous_move = Move{row, col, Move_Action::CHORD};
+
+		// Safe neighbours start the reveal, mines are only revealed after it
+		// so the reveal never spreads from them
+		size_t mines[8];
+		size_t mines_found = 0;
+		revealed_tiles.clear();
+		for (int i = 0; i < 8; ++i) {
+			size_t neighbour = tile_chosen + neighbour_offsets[i];
+			// Border tiles are always revealed, so they are skipped here too
+			if (board[neighbour] & (REVEALED | FLAGGED)) continue;
+			if (board[neighbour] & MINE) mines[mines_found++] = neighbour;
+			else queue_reveal(neighbour);
+		}
+		spread_reveal();
+		for (size_t i = 0; i < mines_found; ++i) {
+			board[mines[i]] |= REVEALED;
+			revealed_tiles.push_back(mines[i]);
+		}
+		revealed_mines += mines_found;
+		return Move_Result{Move_Status::OK, state(), revealed_tiles.size()};
+	}
+
+	// EFFECTS: Returns state of the game
+	Game_State state(void) const {
+		if (revealed_mines > 0) return Game_State::LOST;
+		if (check_if_win()) return Game_State::WON;
+		return Game_State::IN_PROGRESS;
+	}
+
+	// EFFECTS: Checks user has revealed all tiles don't have mines, if so
+	// then returns true. Otherwise, returns false.
+	// Note: O(1), tile_reveal_func() keeps count of the unrevealed safe tiles
+	bool check_if_win(void) const {
+		MINESWEEPER_COUNT(++game_counters().win_checks);
+		return unrevealed_safe_tiles == 0;
+	}
+
+	// EFFECTS: Returns number of tiles without a mine that are not yet revealed
+	size_t number_of_unrevealed_safe_tiles(void) const {
+		return unrevealed_safe_tiles;
+	}
+
+	// EFFECTS: Returns number of tiles on the board that have been revealed
+	size_t revealed_cells(void) const {
+		return total_number_of_tiles - number_of_mines - unrevealed_safe_tiles
+			+ revealed_mines;
+	}
+
+	// REQUIRES: A move has been made since start_game()
+	// EFFECTS: Returns the last move that was made (and not refused)
+	Move last_move(void) const {
+		return previous_move;
+	}
+
+	// EFFECTS: Returns the tiles revealed by the last move, as indexes into
+	// board[] (see row_index() and column_index())
+	const std::vector<size_t>& last_revealed_tiles(void) const {
+		return revealed_tiles;
+	}
+
+	// EFFECTS: Returns a hash of every tile's mine, revealed, flag, and
+	// question mark state
+	// Two games with the same dimensions give the same hash if their boards
+	// look the same (64-bit FNV-1a over the tiles)
+	uint64_t board_digest(void) const {
+		uint64_t hash = 0xCBF29CE484222325ULL;
+		for (int row = 0; row < height; ++row) {
+			const Tile* current_row = &board[Tile_at(row, 0)];
+			for (int col = 0; col < width; ++col) {
+				hash = (hash ^ (current_row[col] & (MINE | REVEALED | FLAGGED | QUESTIONED))) * 0x100000001B3ULL;
+			}
+		}
+		return hash;
+	}
+
+	// EFFECTS: Returns true if the tile at row and col has been revealed
+	bool is_revealed(int row, int col) const {
+		return board[Tile_at(row, col)] & REVEALED;
+	}
+
+	// EFFECTS: Returns true if the tile at row and col is flagged
+	bool is_flagged(int row, int col) const {
+		return board[Tile_at(row, col)] & FLAGGED;
+	}
+
+	// EFFECTS: Returns what the player can see of the tile at row and col
+	Tile_State tile_state(int row, int col) const {
+		Tile current_tile = board[Tile_at(row, col)];
+		if (current_tile & REVEALED) return Tile_State::REVEALED;
+		if (current_tile & FLAGGED) return Tile_State::FLAGGED;
+		if (current_tile & QUESTIONED) return Tile_State::QUESTIONED;
+		return Tile_State::HIDDEN;
+	}
+
+	// REQUIRES: Tile at row and col has been revealed
+	// EFFECTS: Returns number of mines next to the tile at row and col
+	int number_of_nearby_mines(int row, int col) const {
+		assert(is_revealed(row, col));
+		return board[Tile_at(row, col)] & NEARBY_MINES_MASK;
+	}
+
+	// EFFECTS: Returns true if the tile at row and col has a mine
+	// Note: Players shouldn't look at this until the game is over
+	bool has_mine(int row, int col) const {
+		return board[Tile_at(row, col)] & MINE;
+	}
+
+	// EFFECTS: Returns character shown for the tile at row and col
+	// If game_over is false: "?" if the tile hasn't been revealed, "F" if it
+	// is flagged, "Q" if it is question marked, otherwise the number of nearby mines (" " if 0)
+	// If game_over is true: "X" if the tile has a mine, otherwise the number
+	// of nearby mines (" " if 0)
+	char tile_glyph(int row, int col, bool game_over) const {
+		Tile current_tile = board[Tile_at(row, col)];
+		if (game_over) {
+			if (current_tile & MINE) return 'X';
+		}
+		else if (!(current_tile & REVEALED)) {
+			if (current_tile & FLAGGED) return 'F';
+			return (current_tile & QUESTIONED) ? 'Q' : '?';
+		}
+		int number_of_nearby_mines = current_tile & NEARBY_MINES_MASK;
+		if (number_of_nearby_mines == 0) return ' ';
+		return char('0' + number_of_nearby_mines);
+	}
+
+	// EFFECTS: Returns width of the board
+	int get_width(void) const {
+		return width;
+	}
+
+	// EFFECTS: Returns height of the board
+	int get_height(void) const {
+		return height;
+	}
+
+	// EFFECTS: Returns number of mines on the board
+	int get_number_of_mines(void) const {
+		return number_of_mines;
+	}
+
+	// EFFECTS: Returns true if arguements row and col are in bounds of
+	// the game board
+	bool valid_dimensions_chosen(int row, int col) const {
+		if (row >= 0 && row < height && col >= 0 && col < width) return true;
+		return false;
+	}
+
+	// EFFECTS: Places mines for testing and debugging
+	// For debugging and testing purposes only
+	void place_mines_debug(void) {
+		// 15 22 34 42 53 60 62 67 68 74
+		board[tile_from_number(15)] |= MINE;
+		board[tile_from_number(22)] |= MINE;
+		board[tile_from_number(34)] |= MINE;
+		board[tile_from_number(42)] |= MINE;
+		board[tile_from_number(53)] |= MINE;
+		board[tile_from_number(60)] |= MINE;
+		board[tile_from_number(62)] |= MINE;
+		board[tile_from_number(67)] |= MINE;
+		board[tile_from_number(68)] |= MINE;
+		board[tile_from_number(74)] |= MINE;
+		unrevealed_safe_tiles = total_number_of_tiles - 10;
+		mines_are_placed = true;
+
+		// Update the number of nearby mines for each tile
+		count_nearby_mines();
+	}
+
+	// EFFECTS: Returns number of 64-bit words in one bit plane of the board
+	// (see save_planes())
+	size_t words_per_plane(void) const {
+		return (total_number_of_tiles + 63) / 64;
+	}
+
+	// REQUIRES: mines, revealed, and flagged each point to words_per_plane() words
+	// EFFECTS: Writes the board as three bit planes. Bit (n % 64) of word
+	// (n / 64) is set if tile number n has a mine, is revealed, or is flagged.
+	// Unused bits of the last word are 0. Question marks aren't written
+	void save_planes(uint64_t* mines, uint64_t* revealed, uint64_t* flagged) const {
+		std::fill(mines, mines + words_per_plane(), 0);
+		std::fill(revealed, revealed + words_per_plane(), 0);
+		std::fill(flagged, flagged + words_per_plane(), 0);
+		size_t number = 0;
+		for (int row = 0; row < height; ++row) {
+			const Tile* current_row = &board[Tile_at(row, 0)];
+			for (int col = 0; col < width; ++col, ++number) {
+				uint64_t bit = uint64_t(1) << (number % 64);
+				Tile current_tile = current_row[col];
+				if (current_tile & MINE) mines[number / 64] |= bit;
+				if (current_tile & REVEALED) revealed[number / 64] |= bit;
+				if (current_tile & FLAGGED) flagged[number / 64] |= bit;
+			}
+		}
+	}
+
+	// REQUIRES: mines, revealed, and flagged each point to words_per_plane() words
+	// laid out as by save_planes()
+	// EFFECTS: Replaces the board with the one in the bit planes, so the game
+	// carries on from where it was saved. Returns false (and leaves a fresh
+	// board) if the planes don't hold exactly get_number_of_mines() mines
+	bool load_planes(const uint64_t* mines, const uint64_t* revealed, const uint64_t* flagged) {
+		make_board();
+		size_t number = 0;
+		size_t mines_found = 0;
+		size_t safe_tiles_revealed = 0;
+		for (int row = 0; row < height; ++row) {
+			Tile* current_row = &board[Tile_at(row, 0)];
+			for (int col = 0; col < width; ++col, ++number) {
+				size_t word = number / 64;
+				int bit = int(number % 64);
+				Tile current_tile = 0;
+				if ((mines[word] >> bit) & 1) current_tile |= MINE;
+				if ((revealed[word] >> bit) & 1) current_tile |= REVEALED;
+				else if ((flagged[word] >> bit) & 1) current_tile |= FLAGGED;
+				current_row[col] = current_tile;
+				if (current_tile & MINE) {
+					++mines_found;
+					if (current_tile & REVEALED) ++revealed_mines;
+				}
+				else if (current_tile & REVEALED) ++safe_tiles_revealed;
+			}
+		}
+		if (mines_found != size_t(number_of_mines)) {
+			make_board();
+			return false;
+		}
+		unrevealed_safe_tiles = total_number_of_tiles - number_of_mines - safe_tiles_revealed;
+		mines_are_placed = true;
+		count_nearby_mines();
+		return true;
+	}
+
+	// EFFECTS: Creates board based on dimensions (width and height)
+	// Each Tile is initilized to have no mine, no nearby tiles with mines, and not revealed
+	// The place_mines() function will be responsible for placing mines after
+	// make_board() is called
+	void make_board(void) {
+		MINESWEEPER_TIME_STAGE(Stage::MAKE_BOARD);
+		// One allocation for the whole board including the border, made by
+		// the first game only (assign() reuses it after that).
+		// Upon making board, all tiles initially have no mines and is not revealed
+		// We will call another function when randomly placing the mines
+		board.assign((height + 2) * stride, 0);
+		revealed_tiles.clear();
+		revealed_tiles.reserve(std::min(total_number_of_tiles, size_t(4096)));
+		unrevealed_safe_tiles = total_number_of_tiles - number_of_mines;
+		revealed_mines = 0;
+		mines_are_placed = false;
+
+		// Border tiles are marked revealed so that they are never picked,
+		// printed, or spread into by the reveal function
+		Tile* first_row = &board[0];
+		Tile* last_row = &board[(height + 1) * stride];
+		for (size_t col = 0; col < stride; ++col) {
+			first_row[col] = REVEALED;
+			last_row[col] = REVEALED;
+		}
+		for (int row = 0; row < height; ++row) {
+			board[(row + 1) * stride] = REVEALED;
+			board[(row + 1) * stride + width + 1] = REVEALED;
+		}
+	}
+
+	// EFFECTS: Returns a random integer in range [0, x] inclusive
+	// Note: Draws from the game's own random number generator
+	uint64_t random_0_to_x(uint64_t x) {
+		return ::random_0_to_x(rng, x);
+	}
+
+	// EFFECTS: Randomly places mines on the board
+	// Note: Uses Robert Floyd's sampling algorithm. Each mine takes exactly one
+	// random number no matter how crowded the board is, so placing the mines
+	// is O(number_of_mines) and the same seed always gives the same board
+	void place_mines(void) {
+		place_mines_skipping(nullptr, 0);
+	}
+
+	// EFFECTS: Randomly places mines like place_mines(), but never on the tile
+	// at row and col, or the tiles around it if there are enough other tiles
+	// for all of the mines
+	void place_mines_avoiding(int row, int col) {
+		size_t excluded[9];
+		size_t count = 0;
+		for (int r = row - 1; r <= row + 1; ++r) {
+			for (int c = col - 1; c <= col + 1; ++c) {
+				if (valid_dimensions_chosen(r, c)) excluded[count++] = tile_number(r, c);
+			}
+		}
+		if (total_number_of_tiles - count < size_t(number_of_mines)) {
+			// Too crowded to keep the neighbours clear, just keep the tile clear
+			excluded[0] = tile_number(row, col);
+			count = total_number_of_tiles - 1 < size_t(number_of_mines) ? 0 : 1;
+		}
+		// Already in increasing order, as place_mines_skipping() needs
+		place_mines_skipping(excluded, count);
+	}
+
+	// EFFECTS: Calculates number of nearby mines for every tile on the board
+	// Note: The count is a 3x3 sum over the mine bits with the center left out.
+	// Rows are processed 16 tiles at a time with SSE2 when it is available.
+	// The border means no tile needs a bounds check.
+	void count_nearby_mines(void) {
+		MINESWEEPER_TIME_STAGE(Stage::COUNT_NEARBY_MINES);
+		for (int row = 0; row < height; ++row) {
+			Tile* current_row = &board[Tile_at(row, 0)];
+			count_nearby_mines_in_row(current_row - stride, current_row,
+				current_row + stride, current_row);
+		}
+	}
+
+	// EFFECTS: Returns true if the scalar version of count_nearby_mines()
+	// gives the same counts as the ones on the board
+	// For debugging and testing purposes only
+	bool nearby_mine_counts_match_scalar(void) const {
+		std::vector<Tile> expected(width);
+		for (int row = 0; row < height; ++row) {
+			const Tile* current_row = &board[Tile_at(row, 0)];
+			count_nearby_mines_in_range_scalar(current_row - stride, current_row,
+				current_row + stride, expected.data(), 0, width);
+			if (!std::equal(expected.begin(), expected.end(), current_row)) return false;
+		}
+		return true;
+	}
+
+	// EFFECTS: Given a tile, looks for mines nearby the current tile
+	// and calculates number of nearby mines around the current tile
+	// Border tiles never hold a mine, so no bounds checks are needed
+	void look_for_mines_nearby(size_t current_tile) {
+		int x = 0;
+		for (int i = 0; i < 8; ++i) {
+			if (board[current_tile + neighbour_offsets[i]] & MINE) ++x;
+		}
+		board[current_tile] = (board[current_tile] & ~NEARBY_MINES_MASK) | Tile(x);
+	}
+
+	// EFFECTS: Returns index into board[] of the tile given row and column
+	size_t Tile_at(int row, int col) const {
+		return (row + 1) * stride + (col + 1);
+	}
+
+	// EFFECTS: Given row and column indexes, returns tile number
+	// Example, if board is 10x10:
+	// Row 0 Col 0 = Tile 0
+	// Row 0 Col 5 = Tile 5
+	// Row 9 Col 9 = Tile 99
+	size_t tile_number(int row, int col) const {
+		return size_t(row) * width + col;
+	}
+
+	// EFFECTS: Given a tile number, returns index into board[] of the tile
+	size_t tile_from_number(size_t number) const {
+		return Tile_at(int(number / width), int(number % width));
+	}
+
+	// EFFECTS: Returns row index given index of tile in board[]
+	// Note: a tile knows its coordinates from its index, so this is O(1)
+	int row_index(size_t tile) const {
+		return int(tile / stride) - 1;
+	}
+
+	// EFFECTS: Returns column index given index of tile in board[]
+	// Note: a tile knows its coordinates from its index, so this is O(1)
+	int column_index(size_t tile) const {
+		return int(tile % stride) - 1;
+	}
+
+private:
+	// EFFECTS: Returns OK if a move can be made on the tile at row and col
+	Move_Status check_move(int row, int col) const {
+		if (state() != Game_State::IN_PROGRESS) return Move_Status::GAME_OVER;
+		if (!valid_dimensions_chosen(row, col)) return Move_Status::OUT_OF_BOUNDS;
+		if (board[Tile_at(row, col)] & REVEALED) return Move_Status::ALREADY_REVEALED;
+		return Move_Status::OK;
+	}
+
+	// EFFECTS: Toggles mark_bit (FLAGGED or QUESTIONED) on the tile at row
+	// and col, removing the other mark, and records the move as action
+	Move_Result mark(int row, int col, Tile mark_bit, Move_Action action) {
+		MINESWEEPER_TIME_STAGE(Stage::MOVE);
+		Move_Status status = check_move(row, col);
+		if (status != Move_Status::OK) return Move_Result{status, state(), 0};
+		Tile& current_tile = board[Tile_at(row, col)];
+		current_tile = Tile((current_tile ^ mark_bit) & ~((FLAGGED | QUESTIONED) ^ mark_bit));
+		revealed_tiles.clear();
+		previous_move = Move{row, col, action};
+		return Move_Result{Move_Status::OK, state(), 0};
+	}
+
+	// REQUIRES: tile is on the board, not revealed, and has no mine
+	// EFFECTS: Reveals tile. If tile has no nearby mines, keeps revealing outward
+	// in all eight directions until the whole region of tiles with no nearby mines
+	// and its numbered border have been revealed. Flagged tiles are left alone.
+	// Returns the number of tiles revealed.
+	// Note: revealed_tiles[] is used as the work queue, so the reveal never
+	// recurses and reuses the same buffer from one call to the next
+	size_t tile_reveal_func(size_t tile) {
+		revealed_tiles.clear();
+		queue_reveal(tile);
+		return spread_reveal();
+	}
+
+	// REQUIRES: tile is on the board, not revealed, not flagged, and has no mine
+	// EFFECTS: Reveals tile (removing any question mark) and adds it to
+	// revealed_tiles[] for spread_reveal()
+	void queue_reveal(size_t tile) {
+		board[tile] = Tile((board[tile] | REVEALED) & ~QUESTIONED);
+		revealed_tiles.push_back(tile);
+	}
+
+	// EFFECTS: Spreads the reveal outward from every tile in revealed_tiles[]
+	// that has no nearby mines (see tile_reveal_func()), and updates the
+	// count of unrevealed safe tiles. Returns the number of tiles revealed
+	// including the ones already in revealed_tiles[]
+	size_t spread_reveal(void) {
+		MINESWEEPER_TIME_STAGE(Stage::REVEAL);
+		MINESWEEPER_COUNT(size_t cells_visited = revealed_tiles.size();
+			size_t max_queue_depth = revealed_tiles.size());
+		for (size_t next = 0; next < revealed_tiles.size(); ++next) {
+			size_t current_tile = revealed_tiles[next];
+			// Stop spreading at tiles that have nearby mines
+			if (board[current_tile] & NEARBY_MINES_MASK) continue;
+			// Border tiles are always revealed, so they stop the spread
+			for (int i = 0; i < 8; ++i) {
+				size_t neighbour = current_tile + neighbour_offsets[i];
+				if (board[neighbour] & (REVEALED | FLAGGED)) continue;
+				queue_reveal(neighbour);
+			}
+			MINESWEEPER_COUNT(cells_visited += 8;
+				max_queue_depth = std::max(max_queue_depth, revealed_tiles.size() - next - 1));
+		}
+		MINESWEEPER_COUNT(game_counters().add_reveal_pass(cells_visited, max_queue_depth));
+		unrevealed_safe_tiles -= revealed_tiles.size();
+		return revealed_tiles.size();
+	}
+
+	// REQUIRES: excluded holds count tile numbers in increasing order, and
+	// there are at least number_of_mines other tiles
+	// EFFECTS: Places the mines with Floyd's sampling over the tile numbers
+	// that aren't excluded, then counts nearby mines
+	// Note: Sample x is the x-th tile number that isn't excluded, so each of
+	// those tiles is equally likely and excluded tiles never get a mine
+	void place_mines_skipping(const size_t* excluded, size_t count) {
+		{
+			MINESWEEPER_TIME_STAGE(Stage::PLACE_MINES);
+			size_t tiles = total_number_of_tiles - count;
+			for (size_t j = tiles - number_of_mines; j < tiles; ++j) {
+				size_t x = tile_from_number(skip_excluded(random_0_to_x(j), excluded, count));
+				// If tile already has a mine, tile j can't have one yet
+				if (board[x] & MINE) x = tile_from_number(skip_excluded(j, excluded, count));
+				board[x] |= MINE;
+			}
+		}
+		unrevealed_safe_tiles = total_number_of_tiles - number_of_mines;
+		mines_are_placed = true;
+		// Update the number of nearby mines for each tile
+		count_nearby_mines();
+	}
+
+	// EFFECTS: Returns the number-th tile number (from 0) that isn't one of
+	// the count excluded tile numbers, which are in increasing order
+	static size_t skip_excluded(size_t number, const size_t* excluded, size_t count) {
+		for (size_t i = 0; i < count && excluded[i] <= number; ++i) ++number;
+		return number;
+	}
+
+	// REQUIRES: above, current_row, and below point to the first tile of three
+	// rows in a row of board[]. out points to width tiles
+	// EFFECTS: Writes the tiles of current_row to out with their number of
+	// nearby mines filled in. out may be current_row itself
+	void count_nearby_mines_in_row(const Tile* above, const Tile* current_row,
+		const Tile* below, Tile* out) const {
+		size_t col = 0;
+#ifdef __SSE2__
+		const __m128i mine_bits = _mm_set1_epi8(char(MINE));
+		const __m128i count_bits = _mm_set1_epi8(char(NEARBY_MINES_MASK));
+		for (; col + 16 <= size_t(width); col += 16) {
+			// Sum the mine bits (0x10 each) of all eight neighbours. The sum is
+			// at most 0x80, so it fits in a byte and shifting it down by 4 gives the count
+			__m128i sum = _mm_and_si128(load_16(above + col - 1), mine_bits);
+			sum = _mm_add_epi8(sum, _mm_and_si128(load_16(above + col), mine_bits));
+			sum = _mm_add_epi8(sum, _mm_and_si128(load_16(above + col + 1), mine_bits));
+			sum = _mm_add_epi8(sum, _mm_and_si128(load_16(current_row + col - 1), mine_bits));
+			sum = _mm_add_epi8(sum, _mm_and_si128(load_16(current_row + col + 1), mine_bits));
+			sum = _mm_add_epi8(sum, _mm_and_si128(load_16(below + col - 1), mine_bits));
+			sum = _mm_add_epi8(sum, _mm_and_si128(load_16(below + col), mine_bits));
+			sum = _mm_add_epi8(sum, _mm_and_si128(load_16(below + col + 1), mine_bits));
+			__m128i count = _mm_and_si128(_mm_srli_epi16(sum, 4), count_bits);
+			__m128i tiles = _mm_andnot_si128(count_bits, load_16(current_row + col));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + col), _mm_or_si128(tiles, count));
+		}
+#endif
+		count_nearby_mines_in_range_scalar(above, current_row, below, out, col, width);
+	}
+
+	// EFFECTS: Same as count_nearby_mines_in_row(), but only for columns in
+	// range [from, to) and one tile at a time. Used when SSE2 isn't available
+	// and for the last few columns of each row
+	void count_nearby_mines_in_range_scalar(const Tile* above, const Tile* current_row,
+		const Tile* below, Tile* out, size_t from, size_t to) const {
+		for (size_t col = from; col < to; ++col) {
+			int sum = (above[col - 1] & MINE) + (above[col] & MINE) + (above[col + 1] & MINE)
+				+ (current_row[col - 1] & MINE) + (current_row[col + 1] & MINE)
+				+ (below[col - 1] & MINE) + (below[col] & MINE) + (below[col + 1] & MINE);
+			out[col] = Tile((current_row[col] & ~NEARBY_MINES_MASK) | (sum >> 4));
+		}
+	}
+
+#ifdef __SSE2__
+	// EFFECTS: Loads 16 tiles starting at tile
+	static __m128i load_16(const Tile* tile) {
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(tile));
+	}
+#endif
+
+	// EFFECTS: Sets the index offsets from a tile to its eight neighbours
+	void set_neighbour_offsets(void) {
+		ptrdiff_t s = ptrdiff_t(stride);
+		neighbour_offsets[0] = -s;		// North
+		neighbour_offsets[1] = -s + 1;	// Northeast
+		neighbour_offsets[2] = 1;		// East
+		neighbour_offsets[3] = s + 1;	// Southeast
+		neighbour_offsets[4] = s;		// South
+		neighbour_offsets[5] = s - 1;	// Southwest
+		neighbour_offsets[6] = -1;		// West
+		neighbour_offsets[7] = -s - 1;	// Northwest
+	}
+};
+
+#endif
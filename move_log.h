@@ -0,0 +1,383 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef MOVE_LOG_H
+#define MOVE_LOG_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "minesweeper_game.h"
+
+// Move log file layout (version 3):
+//   "MSWEEPLG", then varints: version, width, height, number of mines, seed,
+//   and LOG_FIRST_CLICK_SAFE if the first click was safe (version 1 logs
+//   don't have this last varint)
+//   One record per move: varint (row << ACTION_BITS | action), varint col
+//   When the game ends: varint END_RECORD, then varints: final Game_State,
+//   number of revealed tiles, and Minesweeper_Game::board_digest()
+// Varints are LEB128: 7 bits per byte, lowest bits first, high bit set on
+// every byte but the last. A move in the first 16 rows and 128 columns
+// takes 2 bytes.
+// Version 1 and 2 logs only have reveals and flags, with 2 action bits and
+// an end record of 3.
+
+// Exceptions
+class Move_Log_File_Error {};	// File couldn't be opened, read, or written
+class Invalid_Move_Log {};		// File isn't a move log this version can read
+
+const char MOVE_LOG_MAGIC[8] = { 'M', 'S', 'W', 'E', 'E', 'P', 'L', 'G' };
+const uint64_t MOVE_LOG_VERSION = 3;
+
+// Bits of the game flags in the header
+const uint64_t LOG_FIRST_CLICK_SAFE = 1;
+
+// Action codes in the low ACTION_BITS bits of a record
+const int ACTION_BITS = 3;
+const uint64_t REVEAL_RECORD = 0;
+const uint64_t FLAG_RECORD = 1;
+const uint64_t QUESTION_RECORD = 2;
+const uint64_t CHORD_RECORD = 3;
+const uint64_t END_RECORD = 7;
+
+// Settings a logged game was played with
+struct Move_Log_Header {
+	int width;
+	int height;
+	int number_of_mines;
+	uint64_t seed;
+	bool first_click_safe;
+};
+
+// How a logged game ended
+struct Move_Log_Final_State {
+	Game_State state;
+	uint64_t revealed_cells;
+	uint64_t board_digest;
+};
+
+// Move Log Writer Class
+// Appends moves to a log file through a buffer, so recording a move is a few
+// byte stores and the file is only written once every BUFFER_SIZE bytes
+// The settings are only written once the mines are placed, since a game
+// whose first click is safe may only settle on its seed then (see
+// No_Guess_Generator). Flags and question marks made before that are held
+// in the buffer, and nothing is written to the file until then.
+class Move_Log_Writer {
+private:
+	static const size_t BUFFER_SIZE = 1 << 16;
+	int fd;
+	std::vector<unsigned char> buffer;
+	bool header_written;
+
+public:
+	// Custom Constructor: Creates (or empties) the log at path
+	// Throws Move_Log_File_Error if it can't
+	explicit Move_Log_Writer(const std::string& path) : header_written(false) {
+		fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) throw Move_Log_File_Error();
+		buffer.reserve(BUFFER_SIZE + 32);
+	}
+
+	// Destructor: Writes whatever is still in the buffer (if the settings
+	// have been written)
+	~Move_Log_Writer() {
+		try {
+			flush();
+		}
+		catch (const Move_Log_File_Error&) {}
+		close(fd);
+	}
+
+	Move_Log_Writer(const Move_Log_Writer&) = delete;
+	Move_Log_Writer& operator=(const Move_Log_Writer&) = delete;
+
+	// EFFECTS: Adds the last move made on game to the log
+	void record(const Minesweeper_Game& game) {
+		if (!header_written && game.mines_placed()) write_header(game);
+		Move move = game.last_move();
+		put_varint((uint64_t(move.row) << ACTION_BITS) | action_record(move.action));
+		put_varint(uint64_t(move.col));
+		if (buffer.size() >= BUFFER_SIZE) flush();
+	}
+
+	// REQUIRES: game is over
+	// EFFECTS: Ends the log with how game ended, so a replay can check it
+	// finishes the same way, then writes the log to the file
+	void finish(const Minesweeper_Game& game) {
+		if (!header_written) write_header(game);
+		put_varint(END_RECORD);
+		put_varint(uint64_t(game.state()));
+		put_varint(game.revealed_cells());
+		put_varint(game.board_digest());
+		flush();
+	}
+
+	// EFFECTS: Writes the buffer to the file, unless the settings haven't
+	// been written yet. Throws Move_Log_File_Error if that fails
+	void flush(void) {
+		if (!header_written) return;
+		size_t written = 0;
+		while (written < buffer.size()) {
+			ssize_t n = write(fd, buffer.data() + written, buffer.size() - written);
+			if (n <= 0) throw Move_Log_File_Error();
+			written += size_t(n);
+		}
+		buffer.clear();
+	}
+
+private:
+	// EFFECTS: Returns the action code for action
+	static uint64_t action_record(Move_Action action) {
+		if (action == Move_Action::FLAG) return FLAG_RECORD;
+		if (action == Move_Action::QUESTION) return QUESTION_RECORD;
+		if (action == Move_Action::CHORD) return CHORD_RECORD;
+		return REVEAL_RECORD;
+	}
+
+	// EFFECTS: Puts the settings of game at the start of the buffer, before
+	// the moves made so far
+	void write_header(const Minesweeper_Game& game) {
+		std::vector<unsigned char> moves;
+		moves.swap(buffer);
+		buffer.reserve(BUFFER_SIZE + 32);
+		buffer.insert(buffer.end(), MOVE_LOG_MAGIC, MOVE_LOG_MAGIC + sizeof(MOVE_LOG_MAGIC));
+		put_varint(MOVE_LOG_VERSION);
+		put_varint(uint64_t(game.get_width()));
+		put_varint(uint64_t(game.get_height()));
+		put_varint(uint64_t(game.get_number_of_mines()));
+		put_varint(game.get_seed());
+		put_varint(game.is_first_click_safe() ? LOG_FIRST_CLICK_SAFE : 0);
+		buffer.insert(buffer.end(), moves.begin(), moves.end());
+		header_written = true;
+	}
+
+	// EFFECTS: Appends value to the buffer as a varint
+	void put_varint(uint64_t value) {
+		while (value >= 0x80) {
+			buffer.push_back((unsigned char)(value | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back((unsigned char)value);
+	}
+};
+
+// Move Log Reader Class
+// Reads a log written by Move_Log_Writer one move at a time through a buffer
+class Move_Log_Reader {
+private:
+	static const size_t BUFFER_SIZE = 1 << 16;
+	int fd;
+	std::vector<unsigned char> buffer;
+	size_t position;	// Next byte to read from buffer
+	size_t filled;		// Number of bytes in buffer
+	Move_Log_Header settings;
+	int action_bits;	// ACTION_BITS, or 2 for version 1 and 2 logs
+	bool ended;			// The end record has been read
+	Move_Log_Final_State ending;
+
+public:
+	// Custom Constructor: Opens the log at path and reads its settings
+	// Throws Move_Log_File_Error if it can't be read, Invalid_Move_Log if it
+	// isn't a move log
+	explicit Move_Log_Reader(const std::string& path) :
+		buffer(BUFFER_SIZE), position(0), filled(0), action_bits(ACTION_BITS), ended(false),
+		ending{Game_State::IN_PROGRESS, 0, 0} {
+		fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) throw Move_Log_File_Error();
+		try {
+			char magic[sizeof(MOVE_LOG_MAGIC)];
+			for (char& c : magic) {
+				if (!get_byte(c)) throw Invalid_Move_Log();
+			}
+			if (std::memcmp(magic, MOVE_LOG_MAGIC, sizeof(magic)) != 0) throw Invalid_Move_Log();
+			uint64_t version = get_varint();
+			if (version < 1 || version > MOVE_LOG_VERSION) throw Invalid_Move_Log();
+			if (version < 3) action_bits = 2;
+			settings.width = get_int();
+			settings.height = get_int();
+			settings.number_of_mines = get_int();
+			settings.seed = get_varint();
+			settings.first_click_safe = version >= 2 && (get_varint() & LOG_FIRST_CLICK_SAFE);
+		}
+		catch (...) {
+			close(fd);
+			throw;
+		}
+	}
+
+	// Destructor
+	~Move_Log_Reader() {
+		close(fd);
+	}
+
+	Move_Log_Reader(const Move_Log_Reader&) = delete;
+	Move_Log_Reader& operator=(const Move_Log_Reader&) = delete;
+
+	// EFFECTS: Returns settings the logged game was played with
+	const Move_Log_Header& header(void) const {
+		return settings;
+	}
+
+	// EFFECTS: Reads the next move into move and returns true. Returns false
+	// once there are no more moves. Throws Invalid_Move_Log if a record is cut
+	// off or doesn't make sense
+	bool next(Move& move) {
+		if (ended) return false;
+		char c;
+		if (!peek_byte(c)) return false;	// Log stops without an end record
+		uint64_t first = get_varint();
+		// The end record is the action code with every bit set
+		uint64_t action_mask = (uint64_t(1) << action_bits) - 1;
+		if (first == action_mask) {
+			uint64_t state = get_varint();
+			if (state > uint64_t(Game_State::LOST)) throw Invalid_Move_Log();
+			ending.state = Game_State(state);
+			ending.revealed_cells = get_varint();
+			ending.board_digest = get_varint();
+			ended = true;
+			return false;
+		}
+		uint64_t action = first & action_mask;
+		uint64_t last_action = action_bits == ACTION_BITS ? CHORD_RECORD : FLAG_RECORD;
+		if (action > last_action || (first >> action_bits) > uint64_t(INT32_MAX)) throw Invalid_Move_Log();
+		move.row = int(first >> action_bits);
+		move.col = get_int();
+		if (action == FLAG_RECORD) move.action = Move_Action::FLAG;
+		else if (action == QUESTION_RECORD) move.action = Move_Action::QUESTION;
+		else if (action == CHORD_RECORD) move.action = Move_Action::CHORD;
+		else move.action = Move_Action::REVEAL;
+		return true;
+	}
+
+	// EFFECTS: Returns true if the log ended with how the game finished
+	// Only known once next() has returned false
+	bool has_final_state(void) const {
+		return ended;
+	}
+
+	// REQUIRES: has_final_state()
+	// EFFECTS: Returns how the logged game finished
+	const Move_Log_Final_State& final_state(void) const {
+		return ending;
+	}
+
+private:
+	// EFFECTS: Makes sure buffer has a byte to read. Returns false at the end
+	// of the file
+	bool fill(void) {
+		if (position < filled) return true;
+		ssize_t n = read(fd, buffer.data(), buffer.size());
+		if (n < 0) throw Move_Log_File_Error();
+		position = 0;
+		filled = size_t(n);
+		return n > 0;
+	}
+
+	// EFFECTS: Reads the next byte into c without moving past it
+	bool peek_byte(char& c) {
+		if (!fill()) return false;
+		c = char(buffer[position]);
+		return true;
+	}
+
+	// EFFECTS: Reads the next byte into c
+	bool get_byte(char& c) {
+		if (!peek_byte(c)) return false;
+		++position;
+		return true;
+	}
+
+	// EFFECTS: Reads a varint
+	uint64_t get_varint(void) {
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			char c;
+			if (!get_byte(c)) throw Invalid_Move_Log();
+			unsigned char byte = (unsigned char)c;
+			value |= uint64_t(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) return value;
+		}
+		throw Invalid_Move_Log();
+	}
+
+	// EFFECTS: Reads a varint that has to fit in an int
+	int get_int(void) {
+		uint64_t value = get_varint();
+		if (value > uint64_t(INT32_MAX)) throw Invalid_Move_Log();
+		return int(value);
+	}
+};
+
+// What happened when a log was replayed
+struct Replay_Results {
+	uint64_t moves = 0;
+	bool moves_valid = true;	// Every move was accepted by the engine
+	bool has_final_state = false;	// Log ends with how the game finished
+	bool final_state_matches = false;	// Replay finished the same way
+	Game_State state = Game_State::IN_PROGRESS;	// State after the replay
+	double seconds = 0;		// Time spent making the moves
+
+	// EFFECTS: Returns number of moves replayed per second
+	double moves_per_second(void) const {
+		return seconds > 0 ? moves / seconds : 0;
+	}
+
+	// EFFECTS: Returns true if the replay did exactly what the log says
+	bool ok(void) const {
+		return moves_valid && (!has_final_state || final_state_matches);
+	}
+};
+
+// EFFECTS: Makes move on game
+inline Move_Result apply_move(Minesweeper_Game& game, const Move& move) {
+	if (move.action == Move_Action::FLAG) return game.flag(move.row, move.col);
+	if (move.action == Move_Action::QUESTION) return game.question(move.row, move.col);
+	if (move.action == Move_Action::CHORD) return game.chord(move.row, move.col);
+	return game.reveal(move.row, move.col);
+}
+
+// EFFECTS: Replays the log at path through a new game with the same settings
+// and checks that it ends the way the log says
+// Throws the errors of Move_Log_Reader, and Improper_Dimensions or
+// Improper_Number_of_Mines if the settings aren't a playable board
+inline Replay_Results replay_move_log(const std::string& path) {
+	Move_Log_Reader log(path);
+	const Move_Log_Header& header = log.header();
+	Minesweeper_Game game(header.width, header.height, header.number_of_mines);
+	game.set_first_click_safe(header.first_click_safe);
+	game.set_seed(header.seed);
+	game.start_game();
+
+	Replay_Results results;
+	Move move;
+	auto start = std::chrono::steady_clock::now();
+	while (log.next(move)) {
+		++results.moves;
+		if (apply_move(game, move).status != Move_Status::OK) {
+			results.moves_valid = false;
+			break;
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+	results.seconds = std::chrono::duration<double>(end - start).count();
+	results.state = game.state();
+	results.has_final_state = log.has_final_state();
+	if (results.has_final_state) {
+		const Move_Log_Final_State& ending = log.final_state();
+		results.final_state_matches = ending.state == game.state()
+			&& ending.revealed_cells == game.revealed_cells()
+			&& ending.board_digest == game.board_digest();
+	}
+	return results;
+}
+
+#endif
@@ -0,0 +1,269 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef SERVER_PROTOCOL_H
+#define SERVER_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "minesweeper_game.h"
+
+// Messages between Game_Server and its clients. Every message is a u32
+// length (of everything after it), a Message_Type byte, then its fields.
+// Numbers are little-endian.
+// Client to server:
+//   NEW_GAME   u32 width, u32 height, u32 number of mines, u64 seed (0 for a
+//              random one), u8 flags (NEW_GAME_FIRST_CLICK_SAFE). The client
+//              plays the new game and gets its GAME_INFO
+//   MOVE       u32 game, u8 Move_Action, u32 row, u32 col. Everyone in the
+//              game gets the DELTA, or only the sender if it was refused
+//   WATCH      u32 game, u8 WATCH_AS_PLAYER to play it too. The client gets
+//              the GAME_INFO, then a DELTA with every tile that isn't hidden
+//   LEAVE      u32 game. A game ends once nobody plays or watches it
+// Server to client:
+//   GAME_INFO  u32 game, u32 width, u32 height, u32 number of mines, u64 seed
+//   DELTA      u32 game, u32 number of moves made, u8 Move_Status, u8
+//              Game_State, u32 number of tiles, then for each tile: varint
+//              tile number (row * width + col) and a cell value (see
+//              cell_value()). When the game ends, every mine is sent too
+//   ERROR      u8 Protocol_Error, u32 game (0 if none)
+// Varints are LEB128, like in move logs.
+
+// Exceptions
+class Server_Error {};	// Socket couldn't be opened, bound, or connected to
+class Bad_Message {};	// Message is cut off, too big, or doesn't make sense
+
+enum class Message_Type : unsigned char {
+	NEW_GAME = 1,
+	MOVE = 2,
+	WATCH = 3,
+	LEAVE = 4,
+	GAME_INFO = 129,
+	DELTA = 130,
+	ERROR = 131
+};
+
+enum class Protocol_Error : unsigned char {
+	BAD_MESSAGE = 1,	// Connection is closed after this
+	NO_SUCH_GAME = 2,
+	NOT_A_PLAYER = 3,	// Only watching the game, so can't make moves
+	BAD_BOARD = 4		// NEW_GAME asked for a board that can't be made
+};
+
+const unsigned char NEW_GAME_FIRST_CLICK_SAFE = 1;
+const unsigned char WATCH_AS_PLAYER = 1;
+
+// Size of the length at the start of every message
+const size_t MESSAGE_LENGTH_SIZE = 4;
+
+// Cell values in a DELTA: 0-8 is a revealed tile with that many nearby mines
+const unsigned char CELL_MINE = 9;
+const unsigned char CELL_FLAGGED = 10;
+const unsigned char CELL_QUESTIONED = 11;
+const unsigned char CELL_HIDDEN = 12;
+
+// EFFECTS: Returns the cell value of the tile at row and col. Mines are
+// only given away once the game is over, like Minesweeper_Game::tile_glyph()
+inline unsigned char cell_value(const Minesweeper_Game& game, int row, int col) {
+	if (game.state() != Game_State::IN_PROGRESS && game.has_mine(row, col)) return CELL_MINE;
+	Tile_State state = game.tile_state(row, col);
+	if (state == Tile_State::FLAGGED) return CELL_FLAGGED;
+	if (state == Tile_State::QUESTIONED) return CELL_QUESTIONED;
+	if (state == Tile_State::HIDDEN) return CELL_HIDDEN;
+	return (unsigned char)game.number_of_nearby_mines(row, col);
+}
+
+// Message Builder Class
+// Appends one message to a buffer. The length is filled in by finish()
+class Message_Builder {
+private:
+	std::vector<unsigned char>& out;
+	size_t start;	// Where the message starts in out
+
+public:
+	// Custom Constructor: Starts a message of type type at the end of out_in
+	Message_Builder(std::vector<unsigned char>& out_in, Message_Type type) :
+		out(out_in), start(out_in.size()) {
+		put_u32(0);
+		put_u8((unsigned char)type);
+	}
+
+	// EFFECTS: Returns where the next field will go in the buffer
+	size_t position(void) const {
+		return out.size();
+	}
+
+	void put_u8(unsigned char value) {
+		out.push_back(value);
+	}
+
+	void put_u32(uint32_t value) {
+		for (int i = 0; i < 4; ++i) out.push_back((unsigned char)(value >> (8 * i)));
+	}
+
+	void put_u64(uint64_t value) {
+		for (int i = 0; i < 8; ++i) out.push_back((unsigned char)(value >> (8 * i)));
+	}
+
+	void put_varint(uint64_t value) {
+		while (value >= 0x80) {
+			out.push_back((unsigned char)(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back((unsigned char)value);
+	}
+
+	// REQUIRES: A u32 was put at position
+	// EFFECTS: Replaces that u32 with value
+	void patch_u32(size_t position_in, uint32_t value) {
+		for (int i = 0; i < 4; ++i) out[position_in + i] = (unsigned char)(value >> (8 * i));
+	}
+
+	// EFFECTS: Fills in the length of the message. Call after the last field
+	void finish(void) {
+		patch_u32(start, uint32_t(out.size() - start - MESSAGE_LENGTH_SIZE));
+	}
+};
+
+// Message Parser Class
+// Reads the fields of one message. Throws Bad_Message if a field is missing
+class Message_Parser {
+private:
+	const unsigned char* data;
+	size_t size;
+	size_t position;
+
+public:
+	// Custom Constructor: Parses the fields of the whole message of size_in
+	// bytes at data_in (see message_type() for its type)
+	Message_Parser(const unsigned char* data_in, size_t size_in) :
+		data(data_in), size(size_in), position(MESSAGE_LENGTH_SIZE + 1) {}
+
+	// EFFECTS: Returns true once every byte of the message has been read
+	bool at_end(void) const {
+		return position == size;
+	}
+
+	unsigned char get_u8(void) {
+		if (position >= size) throw Bad_Message();
+		return data[position++];
+	}
+
+	uint32_t get_u32(void) {
+		if (size - position < 4) throw Bad_Message();
+		uint32_t value = 0;
+		for (int i = 0; i < 4; ++i) value |= uint32_t(data[position++]) << (8 * i);
+		return value;
+	}
+
+	uint64_t get_u64(void) {
+		if (size - position < 8) throw Bad_Message();
+		uint64_t value = 0;
+		for (int i = 0; i < 8; ++i) value |= uint64_t(data[position++]) << (8 * i);
+		return value;
+	}
+
+	uint64_t get_varint(void) {
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			unsigned char byte = get_u8();
+			value |= uint64_t(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) return value;
+		}
+		throw Bad_Message();
+	}
+};
+
+// EFFECTS: Returns size of the whole message at the start of the size bytes
+// at data (length included), or 0 if it hasn't all arrived yet. Throws
+// Bad_Message if it would be bigger than max_size
+inline size_t complete_message_size(const unsigned char* data, size_t size, size_t max_size) {
+	if (size < MESSAGE_LENGTH_SIZE + 1) return 0;
+	uint32_t length = 0;
+	for (int i = 0; i < 4; ++i) length |= uint32_t(data[i]) << (8 * i);
+	if (length == 0 || length > max_size - MESSAGE_LENGTH_SIZE) throw Bad_Message();
+	if (size < MESSAGE_LENGTH_SIZE + length) return 0;
+	return MESSAGE_LENGTH_SIZE + length;
+}
+
+// EFFECTS: Returns the type of the whole message at data
+inline Message_Type message_type(const unsigned char* data) {
+	return Message_Type(data[MESSAGE_LENGTH_SIZE]);
+}
+
+// Where a server listens: a port number is TCP on 127.0.0.1, anything else
+// is the path of a Unix socket
+struct Server_Address {
+	sockaddr_storage storage;
+	socklen_t length;
+	bool tcp;
+};
+
+// EFFECTS: Returns the Server_Address for address. Throws Server_Error if it
+// isn't a port number or a path short enough for a Unix socket
+inline Server_Address parse_address(const std::string& address) {
+	Server_Address result;
+	std::memset(&result.storage, 0, sizeof(result.storage));
+	result.tcp = !address.empty() && address.find_first_not_of("0123456789") == std::string::npos;
+	if (result.tcp) {
+		sockaddr_in* in = reinterpret_cast<sockaddr_in*>(&result.storage);
+		in->sin_family = AF_INET;
+		if (address.size() > 5 || std::stoul(address) > 65535) throw Server_Error();
+		in->sin_port = htons(uint16_t(std::stoul(address)));
+		in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		result.length = sizeof(sockaddr_in);
+	}
+	else {
+		sockaddr_un* un = reinterpret_cast<sockaddr_un*>(&result.storage);
+		if (address.empty() || address.size() >= sizeof(un->sun_path)) throw Server_Error();
+		un->sun_family = AF_UNIX;
+		std::memcpy(un->sun_path, address.c_str(), address.size() + 1);
+		result.length = sizeof(sockaddr_un);
+	}
+	return result;
+}
+
+// EFFECTS: Turns off Nagle's algorithm on a TCP socket, so small messages
+// are sent straight away
+inline void set_no_delay(int fd) {
+	int on = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+// EFFECTS: Returns a socket connected to the server at address
+// Throws Server_Error if it can't connect
+inline int connect_to_server(const std::string& address) {
+	Server_Address server = parse_address(address);
+	int fd = socket(server.storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) throw Server_Error();
+	if (connect(fd, reinterpret_cast<const sockaddr*>(&server.storage), server.length) != 0) {
+		close(fd);
+		throw Server_Error();
+	}
+	if (server.tcp) set_no_delay(fd);
+	return fd;
+}
+
+// EFFECTS: Raises this process's limit on open files as far as it is allowed,
+// so thousands of connections can be open at once
+inline void raise_open_file_limit(void) {
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+	limit.rlim_cur = limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+#endif
@@ -0,0 +1,164 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+#include "minesweeper_game.h"
+#include "thread_pool.h"
+
+// Settings for a batch of simulated games
+struct Simulation_Config {
+	int width;
+	int height;
+	int number_of_mines;
+	uint64_t number_of_games;
+	uint64_t base_seed;		// Every game's seed is worked out from this
+	bool first_click_safe = false;	// See Minesweeper_Game::set_first_click_safe()
+};
+
+// Totals for a batch of simulated games
+struct Simulation_Results {
+	uint64_t games = 0;
+	uint64_t wins = 0;
+	uint64_t moves = 0;
+	uint64_t tiles_revealed = 0;
+	uint64_t checksum = 0;	// Sum of a hash of every game's outcome
+	double seconds = 0;		// Wall clock time for the whole batch
+
+	// EFFECTS: Adds the totals of other to these totals
+	void add(const Simulation_Results& other) {
+		games += other.games;
+		wins += other.wins;
+		moves += other.moves;
+		tiles_revealed += other.tiles_revealed;
+		checksum += other.checksum;
+	}
+
+	// EFFECTS: Returns fraction of games won
+	double win_rate(void) const {
+		return games ? double(wins) / games : 0;
+	}
+
+	// EFFECTS: Returns number of games played per second
+	double games_per_second(void) const {
+		return seconds > 0 ? games / seconds : 0;
+	}
+};
+
+// EFFECTS: Returns seed for game number game_index of a batch
+// Note: Depends only on the base seed and the game's number, never on which
+// thread plays the game, so a batch gives the same results on any number
+// of threads
+inline uint64_t simulation_seed(uint64_t base_seed, uint64_t game_index) {
+	return mix_64(base_seed ^ mix_64(game_index));
+}
+
+// Random Player Class
+// Reveals hidden tiles in a random order. It doesn't look at the numbers at
+// all, so it is the baseline other players are measured against.
+// A player must provide, for the Game played (Minesweeper_Game or a
+// Fixed_Board):
+//   void new_game(const Game& game, uint64_t seed)
+//   Move_Result play_move(Game& game)
+class Random_Player {
+private:
+	std::vector<size_t> order;	// Tile numbers; order[0, next) have been tried
+	size_t next;
+	std::mt19937_64 rng;
+
+public:
+	Random_Player() : next(0) {}
+
+	// EFFECTS: Gets ready to play game using seed for its random choices
+	template <class Game>
+	void new_game(const Game& game, uint64_t seed) {
+		order.resize(size_t(game.get_width()) * game.get_height());
+		std::iota(order.begin(), order.end(), size_t(0));
+		next = 0;
+		rng.seed(seed);
+	}
+
+	// REQUIRES: game is in progress
+	// EFFECTS: Reveals a random tile that isn't revealed or flagged
+	// Note: Picks the tiles one Fisher-Yates step at a time, so a whole game
+	// costs O(tiles) no matter how many moves it takes
+	template <class Game>
+	Move_Result play_move(Game& game) {
+		int width = game.get_width();
+		while (1) {
+			size_t pick = next + size_t(random_0_to_x(rng, order.size() - next - 1));
+			std::swap(order[next], order[pick]);
+			size_t tile = order[next++];
+			int row = int(tile / width);
+			int col = int(tile % width);
+			if (game.is_revealed(row, col) || game.is_flagged(row, col)) continue;
+			return game.reveal(row, col);
+		}
+	}
+};
+
+// EFFECTS: Plays config.number_of_games games with Player on every worker in
+// pool and returns the totals. Game is Minesweeper_Game, or the Fixed_Board
+// of config's dimensions, which plays the same games faster
+// Note: Each worker keeps one game and one player and reuses them (and their
+// memory) for every game it plays. The results only depend on config, not on
+// the number of workers or which worker plays which game.
+template <class Player, class Game = Minesweeper_Game>
+Simulation_Results run_simulation(const Simulation_Config& config, Thread_Pool& pool) {
+	// Everything one worker needs. Aligned to a cache line so workers don't
+	// slow each other down when updating their totals
+	struct alignas(64) Worker {
+		Game game;
+		Player player;
+		Simulation_Results totals;
+		explicit Worker(const Simulation_Config& config_in) :
+			game(config_in.width, config_in.height, config_in.number_of_mines) {
+			game.set_first_click_safe(config_in.first_click_safe);
+		}
+	};
+	std::vector<std::unique_ptr<Worker>> workers;
+	for (unsigned i = 0; i < pool.size(); ++i) workers.emplace_back(new Worker(config));
+
+	// Seeds for the players are kept apart from the seeds for the boards
+	const uint64_t player_seed = mix_64(config.base_seed ^ 0x5EED5EED5EED5EEDULL);
+
+	auto start = std::chrono::steady_clock::now();
+	pool.parallel_for(config.number_of_games, 64, [&](unsigned worker, size_t begin, size_t end) {
+		Worker& w = *workers[worker];
+		for (size_t i = begin; i < end; ++i) {
+			w.game.new_game(simulation_seed(config.base_seed, i));
+			w.player.new_game(w.game, simulation_seed(player_seed, i));
+			uint64_t moves = 0;
+			while (w.game.state() == Game_State::IN_PROGRESS) {
+				Move_Result result = w.player.play_move(w.game);
+				++moves;
+				w.totals.tiles_revealed += result.tiles_revealed;
+			}
+			bool won = w.game.state() == Game_State::WON;
+			w.totals.games += 1;
+			w.totals.wins += won ? 1 : 0;
+			w.totals.moves += moves;
+			w.totals.checksum += mix_64(i ^ (moves << 32) ^ (uint64_t(w.game.revealed_cells()) << 1) ^ won);
+		}
+	});
+	auto end = std::chrono::steady_clock::now();
+
+	Simulation_Results results;
+	for (const std::unique_ptr<Worker>& w : workers) results.add(w->totals);
+	results.seconds = std::chrono::duration<double>(end - start).count();
+	return results;
+}
+
+#endif
@@ -0,0 +1,617 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "minesweeper_game.h"
+
+// Solver Class
+// Plays a Minesweeper_Game using only what a player can see. In order:
+//   1. Single tile rules: a number whose mines are all found makes its other
+//      hidden neighbours safe, and a number with as many hidden neighbours as
+//      mines left makes them all mines.
+//   2. Pair rules: two numbers up to two tiles apart that share hidden
+//      neighbours (this covers the usual 1-1 and 1-2 patterns).
+//   3. Exact enumeration: every way of placing mines on each connected group
+//      of hidden tiles next to numbers. Tiles that are safe (or a mine) in every
+//      way are safe (or a mine).
+//   4. If none of that finds a safe tile, reveal the tile least likely to have
+//      a mine.
+// Only the tiles each move reveals are looked at again, so the solver doesn't
+// reanalyse the whole board on every move.
+// It can be used as a player for run_simulation(). Games can be a
+// Minesweeper_Game or a Fixed_Board.
+class Minesweeper_Solver {
+public:
+	// Counts of what the solver did
+	struct Statistics {
+		uint64_t decisions = 0;		// Moves made (reveals and flags)
+		uint64_t guesses = 0;		// Reveals that weren't known to be safe
+		uint64_t enumerations = 0;	// Groups of tiles enumerated
+	};
+
+private:
+	// What the solver knows about each tile
+	static const uint8_t REVEALED = 0x01;	// Revealed (border tiles too)
+	static const uint8_t MINE = 0x02;		// Known to have a mine
+	static const uint8_t SAFE = 0x04;		// Known to be safe, not yet revealed
+	static const uint8_t BORDER = 0x08;		// Not on the board
+	static const uint8_t IN_SINGLE_QUEUE = 0x10;	// In single_rule_queue
+	static const uint8_t IN_PAIR_QUEUE = 0x20;		// In pair_rule_queue
+	static const uint8_t CHANGED = 0x40;	// Number changed since it was last enumerated
+
+	// Largest group of tiles to enumerate, and most search steps per group
+	static const size_t MAX_GROUP_TILES = 48;
+	static const uint64_t MAX_SEARCH_STEPS = 200000;
+
+	// Tiles use the same layout as Minesweeper_Game: a grid with a one tile
+	// border, where tile at row and col is (row + 1) * stride + col + 1
+	int width;
+	int height;
+	size_t stride;
+	ptrdiff_t neighbour_offsets[8];
+
+	std::vector<uint8_t> info;			// What is known about each tile
+	std::vector<uint8_t> mines_left;	// For revealed tiles: number minus known mines around it
+	std::vector<uint8_t> hidden_left;	// For revealed tiles: neighbours not revealed and not known
+	std::vector<float> mine_chance;		// For hidden tiles next to numbers: from the last enumeration
+
+	std::vector<size_t> single_rule_queue;	// Numbers to check with the single tile rules
+	std::vector<size_t> pair_rule_queue;	// Numbers to check with the pair rules
+	std::vector<size_t> safe_tiles;			// Known safe tiles to reveal
+	std::vector<size_t> mine_tiles;			// Known mines to flag
+	std::vector<size_t> numbers;			// Revealed tiles that may still have unknown neighbours
+
+	size_t unknown_tiles;	// Tiles that aren't revealed or known
+	int number_of_mines;
+	int known_mines;
+	bool flag_mines;		// If true, known mines are flagged on the board
+	std::mt19937_64 rng;	// Used to pick between equally good guesses
+	Statistics stats;
+
+	// Scratch space for grouping and enumerating, kept between moves
+	std::vector<uint32_t> visited;		// Equal to visit_number if visited this pass
+	uint32_t visit_number;
+	std::vector<int> local_id;			// Index of a tile within its group
+	std::vector<size_t> frontier;		// Hidden tiles next to numbers, found by the last pass
+	std::vector<size_t> group_tiles;
+	std::vector<size_t> group_numbers;
+	std::vector<std::vector<int>> tile_numbers;		// For each group tile: its numbers
+	std::vector<std::vector<int>> number_tiles;		// For each group number: its tiles
+	std::vector<int> number_target;		// Mines still needed around each group number
+	std::vector<int> number_mines;		// Mines placed around each group number so far
+	std::vector<int> number_open;		// Group tiles around each group number not yet decided
+	std::vector<char> assignment;
+	std::vector<double> mine_solutions;	// For each group tile: solutions where it has a mine
+	double solutions;
+	uint64_t search_steps;
+	int search_mines_limit;
+
+public:
+
+	// Default Constructor: Doesn't flag mines
+	Minesweeper_Solver() : Minesweeper_Solver(false) {}
+
+	// Custom Constructor: If flag_mines_in is true, mines the solver finds are
+	// flagged on the board (each flag is a move)
+	explicit Minesweeper_Solver(bool flag_mines_in) : width(0), height(0), stride(0),
+		unknown_tiles(0), number_of_mines(0), known_mines(0), flag_mines(flag_mines_in),
+		visit_number(0), solutions(0), search_steps(0), search_mines_limit(0) {}
+
+	// EFFECTS: Gets ready to play game using seed to pick between guesses
+	template <class Game>
+	void new_game(const Game& game, uint64_t seed) {
+		width = game.get_width();
+		height = game.get_height();
+		stride = size_t(width) + 2;
+		ptrdiff_t s = ptrdiff_t(stride);
+		ptrdiff_t offsets[8] = { -s, -s + 1, 1, s + 1, s, s - 1, -1, -s - 1 };
+		std::copy(offsets, offsets + 8, neighbour_offsets);
+		assert(game.Tile_at(height - 1, width - 1) == tile_at(height - 1, width - 1));
+
+		size_t size = (size_t(height) + 2) * stride;
+		info.assign(size, 0);
+		mines_left.assign(size, 0);
+		hidden_left.assign(size, 0);
+		mine_chance.assign(size, 0);
+		visited.assign(size, 0);
+		local_id.assign(size, -1);
+		visit_number = 0;
+		for (size_t col = 0; col < stride; ++col) {
+			info[col] = REVEALED | BORDER;
+			info[size - stride + col] = REVEALED | BORDER;
+		}
+		for (int row = 0; row < height; ++row) {
+			info[(row + 1) * stride] = REVEALED | BORDER;
+			info[(row + 1) * stride + width + 1] = REVEALED | BORDER;
+		}
+		single_rule_queue.clear();
+		pair_rule_queue.clear();
+		safe_tiles.clear();
+		mine_tiles.clear();
+		numbers.clear();
+		frontier.clear();
+		reserve_scratch(size_t(width) * height);
+		unknown_tiles = size_t(width) * height;
+		number_of_mines = game.get_number_of_mines();
+		known_mines = 0;
+		rng.seed(seed);
+
+		// The game may already have revealed tiles
+		for (int row = 0; row < height; ++row) {
+			for (int col = 0; col < width; ++col) {
+				if (game.is_revealed(row, col)) learn_revealed(tile_at(row, col), game.number_of_nearby_mines(row, col));
+			}
+		}
+	}
+
+	// REQUIRES: game is in progress, and every move since new_game() was made
+	// by this solver
+	// EFFECTS: Makes one move: reveals a tile known to be safe, flags a known
+	// mine, or reveals the best guess
+	// Note: Flags already on the board (from a loaded game) aren't trusted.
+	// If the tile to reveal is flagged, the move is taking the flag off
+	template <class Game>
+	Move_Result play_move(Game& game) {
+		++stats.decisions;
+		while (1) {
+			while (flag_mines && !mine_tiles.empty()) {
+				size_t tile = mine_tiles.back();
+				mine_tiles.pop_back();
+				if (game.is_flagged(row_of(tile), col_of(tile))) continue;
+				return game.flag(row_of(tile), col_of(tile));
+			}
+			while (!safe_tiles.empty()) {
+				size_t tile = safe_tiles.back();
+				if (game.is_flagged(row_of(tile), col_of(tile))) return game.flag(row_of(tile), col_of(tile));
+				safe_tiles.pop_back();
+				if (game.is_revealed(row_of(tile), col_of(tile))) continue;
+				return reveal(game, tile);
+			}
+			if (apply_single_rules()) continue;
+			if (apply_pair_rules()) continue;
+			if (enumerate_groups()) continue;
+			break;
+		}
+		size_t guess = best_guess();
+		if (game.is_flagged(row_of(guess), col_of(guess))) return game.flag(row_of(guess), col_of(guess));
+		++stats.guesses;
+		return reveal(game, guess);
+	}
+
+	// EFFECTS: Returns counts of what the solver did since it was made
+	const Statistics& statistics(void) const {
+		return stats;
+	}
+
+private:
+	// EFFECTS: Makes room in every work list for the most it can ever hold on
+	// a board of tiles tiles, so a game never grows them
+	// Note: Only the first game on a board this big allocates. Each tile is
+	// queued, learned, and grouped at most once a pass, and search_group()
+	// never takes more than MAX_GROUP_TILES tiles (with at most 8 numbers each)
+	void reserve_scratch(size_t tiles) {
+		std::vector<size_t>* lists[] = { &single_rule_queue, &pair_rule_queue,
+			&safe_tiles, &mine_tiles, &numbers, &frontier, &group_tiles, &group_numbers };
+		for (std::vector<size_t>* list : lists) list->reserve(tiles);
+		const size_t max_numbers = MAX_GROUP_TILES * 8;
+		if (tile_numbers.size() < MAX_GROUP_TILES) {
+			tile_numbers.resize(MAX_GROUP_TILES);
+			number_tiles.resize(max_numbers);
+			for (std::vector<int>& list : tile_numbers) list.reserve(8);
+			for (std::vector<int>& list : number_tiles) list.reserve(8);
+			number_target.reserve(max_numbers);
+			number_mines.reserve(max_numbers);
+			number_open.reserve(max_numbers);
+			assignment.reserve(MAX_GROUP_TILES);
+			mine_solutions.reserve(MAX_GROUP_TILES);
+		}
+	}
+
+	// EFFECTS: Reveals tile and learns from every tile it revealed
+	template <class Game>
+	Move_Result reveal(Game& game, size_t tile) {
+		Move_Result result = game.reveal(row_of(tile), col_of(tile));
+		if (result.state == Game_State::LOST) return result;
+		for (size_t revealed : game.last_revealed_tiles()) {
+			learn_revealed(revealed, game.number_of_nearby_mines(row_of(revealed), col_of(revealed)));
+		}
+		return result;
+	}
+
+	// EFFECTS: Records that tile was revealed with number nearby mines
+	void learn_revealed(size_t tile, int number) {
+		if (info[tile] & REVEALED) return;
+		if (!(info[tile] & (MINE | SAFE))) leave_unknown(tile, false);
+		info[tile] = (info[tile] & ~SAFE) | REVEALED;
+		int mines = 0;
+		int hidden = 0;
+		for (int i = 0; i < 8; ++i) {
+			uint8_t neighbour = info[tile + neighbour_offsets[i]];
+			if (neighbour & MINE) ++mines;
+			else if (!(neighbour & (REVEALED | SAFE))) ++hidden;
+		}
+		assert(number >= mines);
+		mines_left[tile] = uint8_t(number - mines);
+		hidden_left[tile] = uint8_t(hidden);
+		if (hidden > 0) {
+			numbers.push_back(tile);
+			number_changed(tile);
+		}
+	}
+
+	// EFFECTS: Records that tile is known to have a mine
+	void learn_mine(size_t tile) {
+		if (info[tile] & (REVEALED | MINE | SAFE)) return;
+		info[tile] |= MINE;
+		++known_mines;
+		leave_unknown(tile, true);
+		if (flag_mines) mine_tiles.push_back(tile);
+	}
+
+	// EFFECTS: Records that tile is known to be safe
+	void learn_safe(size_t tile) {
+		if (info[tile] & (REVEALED | MINE | SAFE)) return;
+		info[tile] |= SAFE;
+		leave_unknown(tile, false);
+		safe_tiles.push_back(tile);
+	}
+
+	// EFFECTS: Updates the numbers around tile now that tile is no longer unknown
+	void leave_unknown(size_t tile, bool is_mine) {
+		--unknown_tiles;
+		for (int i = 0; i < 8; ++i) {
+			size_t neighbour = tile + neighbour_offsets[i];
+			if ((info[neighbour] & (REVEALED | BORDER)) != REVEALED) continue;
+			assert(hidden_left[neighbour] > 0);
+			--hidden_left[neighbour];
+			if (is_mine) {
+				assert(mines_left[neighbour] > 0);
+				--mines_left[neighbour];
+			}
+			number_changed(neighbour);
+		}
+	}
+
+	// EFFECTS: Queues number at tile to be checked again
+	void number_changed(size_t tile) {
+		info[tile] |= CHANGED;
+		if (!(info[tile] & IN_SINGLE_QUEUE)) {
+			info[tile] |= IN_SINGLE_QUEUE;
+			single_rule_queue.push_back(tile);
+		}
+		if (!(info[tile] & IN_PAIR_QUEUE)) {
+			info[tile] |= IN_PAIR_QUEUE;
+			pair_rule_queue.push_back(tile);
+		}
+	}
+
+	// EFFECTS: Returns true if tile isn't revealed or known
+	bool is_unknown(size_t tile) const {
+		return !(info[tile] & (REVEALED | MINE | SAFE));
+	}
+
+	// EFFECTS: Applies the single tile rules to every queued number until
+	// nothing new is found. Returns true if anything was found
+	bool apply_single_rules(void) {
+		bool found = false;
+		while (!single_rule_queue.empty()) {
+			size_t tile = single_rule_queue.back();
+			single_rule_queue.pop_back();
+			info[tile] &= ~IN_SINGLE_QUEUE;
+			if (hidden_left[tile] == 0) continue;
+			bool all_safe = mines_left[tile] == 0;
+			bool all_mines = mines_left[tile] == hidden_left[tile];
+			if (!all_safe && !all_mines) continue;
+			for (int i = 0; i < 8; ++i) {
+				size_t neighbour = tile + neighbour_offsets[i];
+				if (!is_unknown(neighbour)) continue;
+				if (all_safe) learn_safe(neighbour);
+				else learn_mine(neighbour);
+			}
+			found = true;
+		}
+		return found;
+	}
+
+	// EFFECTS: Applies the pair rules to queued numbers until one of them finds
+	// something. Returns true if anything was found
+	bool apply_pair_rules(void) {
+		size_t a_tiles[8], b_tiles[8];
+		while (!pair_rule_queue.empty()) {
+			size_t a = pair_rule_queue.back();
+			pair_rule_queue.pop_back();
+			info[a] &= ~IN_PAIR_QUEUE;
+			if (hidden_left[a] == 0) continue;
+			int a_count = hidden_tiles_of(a, a_tiles);
+			int a_row = int(a / stride);
+			int a_col = int(a % stride);
+			for (int dr = -2; dr <= 2; ++dr) {
+				int b_row = a_row + dr;
+				if (b_row < 1 || b_row > height) continue;
+				for (int dc = -2; dc <= 2; ++dc) {
+					int b_col = a_col + dc;
+					if ((dr == 0 && dc == 0) || b_col < 1 || b_col > width) continue;
+					size_t b = size_t(b_row) * stride + size_t(b_col);
+					if (!(info[b] & REVEALED) || hidden_left[b] == 0) continue;
+					int b_count = hidden_tiles_of(b, b_tiles);
+					if (apply_pair_rule(a, a_tiles, a_count, b, b_tiles, b_count) ||
+						apply_pair_rule(b, b_tiles, b_count, a, a_tiles, a_count)) {
+						// The rest of a's pairs are checked when a comes up again
+						number_changed(a);
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	// EFFECTS: Applies the pair rule to numbers a and b. Returns true if
+	// anything was found
+	// Note: If b needs as many more mines than a as it has hidden tiles that a
+	// doesn't, then those tiles are all mines, a's mines are all in the tiles
+	// they share, and a's hidden tiles that b doesn't have are all safe. When
+	// b's hidden tiles are all shared with a this is the subset rule.
+	bool apply_pair_rule(size_t a, const size_t* a_tiles, int a_count,
+		size_t b, const size_t* b_tiles, int b_count) {
+		int only_a = 0;
+		int only_b = 0;
+		for (int i = 0; i < b_count; ++i) {
+			if (std::find(a_tiles, a_tiles + a_count, b_tiles[i]) == a_tiles + a_count) ++only_b;
+		}
+		for (int i = 0; i < a_count; ++i) {
+			if (std::find(b_tiles, b_tiles + b_count, a_tiles[i]) == b_tiles + b_count) ++only_a;
+		}
+		if (only_a == 0 && only_b == 0) return false;
+		if (int(mines_left[b]) - int(mines_left[a]) != only_b) return false;
+		for (int i = 0; i < b_count; ++i) {
+			if (std::find(a_tiles, a_tiles + a_count, b_tiles[i]) == a_tiles + a_count) learn_mine(b_tiles[i]);
+		}
+		for (int i = 0; i < a_count; ++i) {
+			if (std::find(b_tiles, b_tiles + b_count, a_tiles[i]) == b_tiles + b_count) learn_safe(a_tiles[i]);
+		}
+		return true;
+	}
+
+	// EFFECTS: Writes the unknown neighbours of tile to out and returns how many
+	int hidden_tiles_of(size_t tile, size_t* out) const {
+		int count = 0;
+		for (int i = 0; i < 8; ++i) {
+			size_t neighbour = tile + neighbour_offsets[i];
+			if (is_unknown(neighbour)) out[count++] = neighbour;
+		}
+		return count;
+	}
+
+	// EFFECTS: Splits the hidden tiles next to numbers into groups that share
+	// no numbers, and enumerates every group whose numbers changed since it
+	// was last enumerated. Fills in frontier[] and mine_chance[].
+	// Returns true if a safe tile or a mine was found
+	bool enumerate_groups(void) {
+		++visit_number;
+		frontier.clear();
+		bool found = false;
+		size_t kept = 0;
+		for (size_t i = 0; i < numbers.size(); ++i) {
+			size_t number = numbers[i];
+			if (hidden_left[number] == 0) continue;
+			numbers[kept++] = number;	// Numbers with nothing left to find are dropped
+			if (visited[number] == visit_number) continue;
+			found |= enumerate_group(number);
+		}
+		numbers.resize(kept);
+		return found;
+	}
+
+	// EFFECTS: Collects the group of hidden tiles and numbers connected to
+	// number and enumerates it if any of its numbers changed.
+	// Returns true if a safe tile or a mine was found
+	bool enumerate_group(size_t number) {
+		group_tiles.clear();
+		group_numbers.clear();
+		visited[number] = visit_number;
+		group_numbers.push_back(number);
+		bool changed = false;
+		for (size_t next = 0; next < group_numbers.size(); ++next) {
+			size_t current = group_numbers[next];
+			changed |= (info[current] & CHANGED) != 0;
+			info[current] &= ~CHANGED;
+			for (int i = 0; i < 8; ++i) {
+				size_t tile = current + neighbour_offsets[i];
+				if (!is_unknown(tile) || visited[tile] == visit_number) continue;
+				visited[tile] = visit_number;
+				group_tiles.push_back(tile);
+				for (int j = 0; j < 8; ++j) {
+					size_t other = tile + neighbour_offsets[j];
+					if ((info[other] & (REVEALED | BORDER)) != REVEALED) continue;
+					if (visited[other] == visit_number) continue;
+					visited[other] = visit_number;
+					group_numbers.push_back(other);
+				}
+			}
+		}
+		frontier.insert(frontier.end(), group_tiles.begin(), group_tiles.end());
+		// A group that hasn't changed has the same answer as last time
+		if (!changed) return false;
+		++stats.enumerations;
+		if (!search_group()) {
+			// Too big to enumerate: use the most crowded number next to each tile
+			for (size_t tile : group_tiles) {
+				float chance = 0;
+				for (int i = 0; i < 8; ++i) {
+					size_t other = tile + neighbour_offsets[i];
+					if ((info[other] & (REVEALED | BORDER)) != REVEALED || hidden_left[other] == 0) continue;
+					chance = std::max(chance, float(mines_left[other]) / hidden_left[other]);
+				}
+				mine_chance[tile] = chance;
+			}
+			return false;
+		}
+		bool found = false;
+		for (size_t i = 0; i < group_tiles.size(); ++i) {
+			mine_chance[group_tiles[i]] = float(mine_solutions[i] / solutions);
+			if (mine_solutions[i] == 0) {
+				learn_safe(group_tiles[i]);
+				found = true;
+			}
+			else if (mine_solutions[i] == solutions) {
+				learn_mine(group_tiles[i]);
+				found = true;
+			}
+		}
+		return found;
+	}
+
+	// EFFECTS: Counts every way of placing mines on group_tiles that agrees
+	// with group_numbers. Fills in solutions and mine_solutions[]. Returns
+	// false if the group is too big or the search took too long
+	bool search_group(void) {
+		size_t tiles = group_tiles.size();
+		size_t count = group_numbers.size();
+		if (tiles > MAX_GROUP_TILES) return false;
+		for (size_t i = 0; i < tiles; ++i) local_id[group_tiles[i]] = int(i);
+		tile_numbers.resize(std::max(tile_numbers.size(), tiles));
+		number_tiles.resize(std::max(number_tiles.size(), count));
+		for (size_t i = 0; i < tiles; ++i) tile_numbers[i].clear();
+		number_target.assign(count, 0);
+		number_mines.assign(count, 0);
+		number_open.assign(count, 0);
+		for (size_t n = 0; n < count; ++n) {
+			size_t number = group_numbers[n];
+			number_tiles[n].clear();
+			for (int i = 0; i < 8; ++i) {
+				size_t tile = number + neighbour_offsets[i];
+				if (!is_unknown(tile)) continue;
+				number_tiles[n].push_back(local_id[tile]);
+				tile_numbers[local_id[tile]].push_back(int(n));
+			}
+			number_target[n] = mines_left[number];
+			number_open[n] = int(number_tiles[n].size());
+		}
+		assignment.assign(tiles, 0);
+		mine_solutions.assign(tiles, 0);
+		solutions = 0;
+		search_steps = 0;
+		search_mines_limit = number_of_mines - known_mines;
+		bool finished = search(0, 0);
+		for (size_t i = 0; i < tiles; ++i) local_id[group_tiles[i]] = -1;
+		return finished && solutions > 0;
+	}
+
+	// EFFECTS: Tries both choices for group tile next and everything after it.
+	// Returns false if the search ran out of steps
+	bool search(size_t next, int mines_placed) {
+		if (++search_steps > MAX_SEARCH_STEPS) return false;
+		if (next == group_tiles.size()) {
+			solutions += 1;
+			for (size_t i = 0; i < group_tiles.size(); ++i) {
+				if (assignment[i]) mine_solutions[i] += 1;
+			}
+			return true;
+		}
+		for (int mine = 0; mine <= 1; ++mine) {
+			if (mine && mines_placed == search_mines_limit) break;
+			bool fits = true;
+			for (int n : tile_numbers[next]) {
+				int mines = number_mines[n] + mine;
+				int open = number_open[n] - 1;
+				if (mines > number_target[n] || mines + open < number_target[n]) fits = false;
+			}
+			if (!fits) continue;
+			for (int n : tile_numbers[next]) {
+				number_mines[n] += mine;
+				--number_open[n];
+			}
+			assignment[next] = char(mine);
+			bool finished = search(next + 1, mines_placed + mine);
+			for (int n : tile_numbers[next]) {
+				number_mines[n] -= mine;
+				++number_open[n];
+			}
+			if (!finished) return false;
+		}
+		return true;
+	}
+
+	// EFFECTS: Returns the unknown tile least likely to have a mine
+	// Note: Tiles that aren't next to any number all share the mines that
+	// aren't expected next to numbers
+	size_t best_guess(void) {
+		size_t best = 0;
+		float best_chance = 2;
+		double frontier_mines = 0;
+		for (size_t tile : frontier) {
+			frontier_mines += mine_chance[tile];
+			if (mine_chance[tile] < best_chance) {
+				best_chance = mine_chance[tile];
+				best = tile;
+			}
+		}
+		size_t others = unknown_tiles - frontier.size();
+		if (others > 0) {
+			double chance = (number_of_mines - known_mines - frontier_mines) / others;
+			if (best == 0 || chance < best_chance) {
+				size_t tile = random_unconstrained_tile();
+				if (tile != 0) return tile;
+			}
+		}
+		assert(best != 0);
+		return best;
+	}
+
+	// EFFECTS: Returns a random unknown tile that isn't next to any number,
+	// or 0 if there isn't one
+	size_t random_unconstrained_tile(void) {
+		size_t total = size_t(width) * height;
+		// Random tries first, since most tiles are unconstrained early on
+		for (int tries = 0; tries < 64; ++tries) {
+			size_t number = random_0_to_x(rng, total - 1);
+			size_t tile = tile_at(int(number / width), int(number % width));
+			if (is_unconstrained(tile)) return tile;
+		}
+		size_t start = random_0_to_x(rng, total - 1);
+		for (size_t i = 0; i < total; ++i) {
+			size_t number = (start + i) % total;
+			size_t tile = tile_at(int(number / width), int(number % width));
+			if (is_unconstrained(tile)) return tile;
+		}
+		return 0;
+	}
+
+	// EFFECTS: Returns true if tile is unknown and not next to a revealed tile
+	bool is_unconstrained(size_t tile) const {
+		if (!is_unknown(tile)) return false;
+		for (int i = 0; i < 8; ++i) {
+			if ((info[tile + neighbour_offsets[i]] & (REVEALED | BORDER)) == REVEALED) return false;
+		}
+		return true;
+	}
+
+	// EFFECTS: Returns tile at row and col
+	size_t tile_at(int row, int col) const {
+		return (size_t(row) + 1) * stride + size_t(col) + 1;
+	}
+
+	// EFFECTS: Returns row of tile
+	int row_of(size_t tile) const {
+		return int(tile / stride) - 1;
+	}
+
+	// EFFECTS: Returns column of tile
+	int col_of(size_t tile) const {
+		return int(tile % stride) - 1;
+	}
+};
+
+#endif
@@ -0,0 +1,539 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+// Tests for the engine, the solver, snapshots, and move logs. Every check
+// that fails is printed, and the program exits with 1 if any did, so ctest
+// can run it.
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
+#include <vector>
+#include "board_snapshot.h"
+#include "fixed_board.h"
+#include "minesweeper_game.h"
+#include "move_log.h"
+#include "solver.h"
+
+using namespace std;
+
+// Number of checks that failed so far
+int failures = 0;
+
+// Heap allocations made so far, counted by every operator new below
+atomic<uint64_t> allocations(0);
+
+// EFFECTS: Counts an allocation of size bytes aligned to alignment (0 for
+// the usual alignment) and returns it, or nullptr if there is no memory
+void* counted_allocation(size_t size, size_t alignment) {
+	allocations.fetch_add(1, memory_order_relaxed);
+	if (size == 0) size = 1;
+	if (alignment == 0) return malloc(size);
+	// aligned_alloc() needs a size that is a multiple of the alignment
+	return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+// EFFECTS: Same as counted_allocation(), but throws bad_alloc instead of
+// returning nullptr
+void* counted_allocation_or_throw(size_t size, size_t alignment) {
+	if (void* memory = counted_allocation(size, alignment)) return memory;
+	throw bad_alloc();
+}
+
+// The whole family of operator new and delete is replaced, so every
+// allocation is counted and every one is freed the same way
+void* operator new(size_t size) {
+	return counted_allocation_or_throw(size, 0);
+}
+
+void* operator new[](size_t size) {
+	return counted_allocation_or_throw(size, 0);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+	return counted_allocation(size, 0);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+	return counted_allocation(size, 0);
+}
+
+void* operator new(size_t size, align_val_t alignment) {
+	return counted_allocation_or_throw(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, align_val_t alignment) {
+	return counted_allocation_or_throw(size, size_t(alignment));
+}
+
+void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept {
+	return counted_allocation(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept {
+	return counted_allocation(size, size_t(alignment));
+}
+
+void operator delete(void* memory) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, const nothrow_t&) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory, const nothrow_t&) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, align_val_t) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory, align_val_t) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, size_t, align_val_t) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory, size_t, align_val_t) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, align_val_t, const nothrow_t&) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory, align_val_t, const nothrow_t&) noexcept {
+	free(memory);
+}
+
+// EFFECTS: Counts and prints a failure if ok is false
+void check(bool ok, const char* what, const char* file, int line) {
+	if (ok) return;
+	++failures;
+	cout << file << ":" << line << ": check failed: " << what << endl;
+}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+// EFFECTS: Returns a path for a temporary file called name
+string temporary_path(const string& name) {
+	return "/tmp/minesweeper_tests_" + to_string(getpid()) + "_" + name;
+}
+
+// EFFECTS: Returns number of mines around the tile at row and col, counted
+// from has_mine()
+int count_mines_around(const Minesweeper_Game& game, int row, int col) {
+	int mines = 0;
+	for (int r = row - 1; r <= row + 1; ++r) {
+		for (int c = col - 1; c <= col + 1; ++c) {
+			if ((r != row || c != col) && game.valid_dimensions_chosen(r, c) && game.has_mine(r, c)) ++mines;
+		}
+	}
+	return mines;
+}
+
+// EFFECTS: Finds a tile without a mine and with no mines around it. Returns
+// false if there isn't one
+bool find_empty_tile(const Minesweeper_Game& game, int& row, int& col) {
+	for (row = 0; row < game.get_height(); ++row) {
+		for (col = 0; col < game.get_width(); ++col) {
+			if (!game.has_mine(row, col) && count_mines_around(game, row, col) == 0) return true;
+		}
+	}
+	return false;
+}
+
+// EFFECTS: Checks that a reveal opens up the whole area of tiles with no
+// mines around them and its numbered edge, and nothing else, and that moves
+// the rules don't allow are refused
+void test_reveal(void) {
+	for (uint64_t seed = 1; seed <= 50; ++seed) {
+		Minesweeper_Game game(16, 16, 40);
+		game.new_game(seed);
+		int row = 0;
+		int col = 0;
+		if (!find_empty_tile(game, row, col)) continue;
+		Move_Result result = game.reveal(row, col);
+		CHECK(result.status == Move_Status::OK);
+		CHECK(result.tiles_revealed == game.last_revealed_tiles().size());
+		CHECK(result.tiles_revealed == game.revealed_cells());
+		for (int r = 0; r < game.get_height(); ++r) {
+			for (int c = 0; c < game.get_width(); ++c) {
+				if (!game.is_revealed(r, c)) continue;
+				CHECK(!game.has_mine(r, c));
+				CHECK(game.number_of_nearby_mines(r, c) == count_mines_around(game, r, c));
+				if (game.number_of_nearby_mines(r, c) != 0) continue;
+				// Tiles next to an empty tile are always revealed with it
+				for (int nr = r - 1; nr <= r + 1; ++nr) {
+					for (int nc = c - 1; nc <= c + 1; ++nc) {
+						if (game.valid_dimensions_chosen(nr, nc)) CHECK(game.is_revealed(nr, nc));
+					}
+				}
+			}
+		}
+		CHECK(game.reveal(row, col).status == Move_Status::ALREADY_REVEALED);
+		CHECK(game.reveal(-1, 0).status == Move_Status::OUT_OF_BOUNDS);
+		CHECK(game.reveal(0, game.get_width()).status == Move_Status::OUT_OF_BOUNDS);
+
+		// Flagged tiles can't be revealed until the flag is taken off
+		int mine_row = -1;
+		int mine_col = -1;
+		for (int r = 0; r < game.get_height() && mine_row < 0; ++r) {
+			for (int c = 0; c < game.get_width(); ++c) {
+				if (game.has_mine(r, c)) {
+					mine_row = r;
+					mine_col = c;
+					break;
+				}
+			}
+		}
+		CHECK(game.flag(mine_row, mine_col).status == Move_Status::OK);
+		CHECK(game.tile_state(mine_row, mine_col) == Tile_State::FLAGGED);
+		CHECK(game.reveal(mine_row, mine_col).status == Move_Status::FLAGGED);
+		CHECK(game.question(mine_row, mine_col).status == Move_Status::OK);
+		CHECK(game.tile_state(mine_row, mine_col) == Tile_State::QUESTIONED);
+		result = game.reveal(mine_row, mine_col);
+		CHECK(result.status == Move_Status::OK && result.state == Game_State::LOST);
+		CHECK(game.state() == Game_State::LOST);
+		CHECK(game.reveal(row, col).status == Move_Status::GAME_OVER);
+	}
+}
+
+// EFFECTS: Checks that chording a number with the right flags around it
+// reveals its other neighbours, and that wrong chords are refused or lose
+void test_chord(void) {
+	int chords = 0;
+	for (uint64_t seed = 1; seed <= 50; ++seed) {
+		Minesweeper_Game game(16, 16, 40);
+		game.new_game(seed);
+		int row = 0;
+		int col = 0;
+		if (!find_empty_tile(game, row, col)) continue;
+		game.reveal(row, col);
+		CHECK(game.chord(0, 0).status == Move_Status::NOT_REVEALED || game.is_revealed(0, 0));
+
+		// Find a revealed number with a hidden safe tile next to it
+		for (int r = 0; r < game.get_height(); ++r) {
+			for (int c = 0; c < game.get_width(); ++c) {
+				if (!game.is_revealed(r, c) || game.number_of_nearby_mines(r, c) == 0) continue;
+				bool hidden_safe = false;
+				int flags = 0;
+				for (int nr = r - 1; nr <= r + 1; ++nr) {
+					for (int nc = c - 1; nc <= c + 1; ++nc) {
+						if (!game.valid_dimensions_chosen(nr, nc)) continue;
+						if (!game.is_revealed(nr, nc) && !game.has_mine(nr, nc)) hidden_safe = true;
+						if (game.is_flagged(nr, nc)) ++flags;
+					}
+				}
+				if (!hidden_safe || game.state() != Game_State::IN_PROGRESS) continue;
+
+				if (flags != game.number_of_nearby_mines(r, c)) {
+					CHECK(game.chord(r, c).status == Move_Status::WRONG_NUMBER_OF_FLAGS);
+				}
+				for (int nr = r - 1; nr <= r + 1; ++nr) {
+					for (int nc = c - 1; nc <= c + 1; ++nc) {
+						if (game.valid_dimensions_chosen(nr, nc) && game.has_mine(nr, nc)
+							&& !game.is_flagged(nr, nc)) game.flag(nr, nc);
+					}
+				}
+				Move_Result result = game.chord(r, c);
+				CHECK(result.status == Move_Status::OK);
+				CHECK(result.state != Game_State::LOST);
+				CHECK(result.tiles_revealed > 0);
+				for (int nr = r - 1; nr <= r + 1; ++nr) {
+					for (int nc = c - 1; nc <= c + 1; ++nc) {
+						if (game.valid_dimensions_chosen(nr, nc) && !game.has_mine(nr, nc)) {
+							CHECK(game.is_revealed(nr, nc));
+						}
+					}
+				}
+				++chords;
+			}
+		}
+	}
+	CHECK(chords > 0);
+
+	// A wrong flag loses the game when chorded
+	for (uint64_t seed = 1; seed <= 50; ++seed) {
+		Minesweeper_Game game(9, 9, 10);
+		game.new_game(seed);
+		int row = 0;
+		int col = 0;
+		if (!find_empty_tile(game, row, col)) continue;
+		game.reveal(row, col);
+		for (int r = 0; r < game.get_height(); ++r) {
+			for (int c = 0; c < game.get_width(); ++c) {
+				if (!game.is_revealed(r, c) || game.number_of_nearby_mines(r, c) != 1) continue;
+				// Flag a safe hidden neighbour instead of the mine
+				int safe_row = -1;
+				int safe_col = -1;
+				for (int nr = r - 1; nr <= r + 1; ++nr) {
+					for (int nc = c - 1; nc <= c + 1; ++nc) {
+						if (game.valid_dimensions_chosen(nr, nc) && !game.is_revealed(nr, nc)
+							&& !game.has_mine(nr, nc)) {
+							safe_row = nr;
+							safe_col = nc;
+						}
+					}
+				}
+				if (safe_row < 0) continue;
+				game.flag(safe_row, safe_col);
+				Move_Result result = game.chord(r, c);
+				CHECK(result.status == Move_Status::OK && result.state == Game_State::LOST);
+				return;
+			}
+		}
+	}
+	CHECK(!"no board had a number to chord with a wrong flag");
+}
+
+// EFFECTS: Checks the mine counts made 16 tiles at a time with SSE2 against
+// the scalar version and against has_mine(), on random boards of every width
+// from 2 to 70 (so most rows end in a scalar tail) and densities from one mine
+// to a board full of them
+void test_nearby_mine_counts(void) {
+	uint64_t seed = 1;
+	for (int width = 2; width <= 70; ++width) {
+		for (int height = 2; height <= 6; height += 2) {
+			int tiles = width * height;
+			int mine_counts[] = { 1, tiles / 10 + 1, tiles / 4 + 1, tiles / 2, tiles * 9 / 10, tiles };
+			for (int mines : mine_counts) {
+				Minesweeper_Game game(width, height, mines);
+				game.new_game(seed++);
+				CHECK(game.nearby_mine_counts_match_scalar());
+				for (int row = 0; row < height; ++row) {
+					for (int col = 0; col < width; ++col) {
+						if (game.has_mine(row, col)) continue;
+						int nearby = count_mines_around(game, row, col);
+						CHECK(game.tile_glyph(row, col, true) == (nearby == 0 ? ' ' : char('0' + nearby)));
+					}
+				}
+			}
+		}
+	}
+}
+
+// EFFECTS: Plays games with the solver one after another on game, and
+// checks that starting and playing every game after the first makes no
+// heap allocations
+template <class Game>
+void check_back_to_back_games_allocate_nothing(Game& game) {
+	Minesweeper_Solver solver(true);
+	uint64_t seed = 1;
+	auto play_game = [&] {
+		game.new_game(seed);
+		solver.new_game(game, seed++);
+		while (game.state() == Game_State::IN_PROGRESS) solver.play_move(game);
+	};
+	// The first game makes the memory every game after it reuses
+	play_game();
+	uint64_t before = allocations.load();
+	for (int i = 0; i < 200; ++i) play_game();
+	CHECK(allocations.load() == before);
+}
+
+// EFFECTS: Checks that back to back games allocate nothing on the classic
+// boards, both on a Minesweeper_Game and on their Fixed_Board, and that the
+// counting allocator does count
+void test_no_allocations_between_games(void) {
+	// Kept in volatile pointers so the compiler can't leave the allocations out
+	uint64_t before = allocations.load();
+	int* volatile one = new int(0);
+	int* volatile many = new int[4];
+	CHECK(allocations.load() == before + 2);
+	delete one;
+	delete[] many;
+
+	for (const Board_Preset& preset : BOARD_PRESETS) {
+		Minesweeper_Game game(preset.width, preset.height, preset.number_of_mines);
+		check_back_to_back_games_allocate_nothing(game);
+		with_fixed_board(preset.width, preset.height, preset.number_of_mines, [&](auto board_type) {
+			typename decltype(board_type)::type fixed;
+			check_back_to_back_games_allocate_nothing(fixed);
+		});
+	}
+}
+
+// EFFECTS: Plays part of a game with the solver (flagging mines), then
+// checks the snapshot of it loads back to the same game
+void test_snapshot_round_trip(void) {
+	string path = temporary_path("snapshot.bin");
+	for (uint64_t seed = 1; seed <= 20; ++seed) {
+		Minesweeper_Game game(30, 16, 99);
+		game.set_first_click_safe(true);
+		game.new_game(seed);
+		game.reveal(8, 15);
+		Minesweeper_Solver solver(true);
+		solver.new_game(game, seed);
+		for (int i = 0; i < 40 && game.state() == Game_State::IN_PROGRESS; ++i) solver.play_move(game);
+		save_snapshot(game, path);
+		unique_ptr<Minesweeper_Game> loaded = load_snapshot(path);
+		CHECK(loaded->get_width() == game.get_width());
+		CHECK(loaded->get_height() == game.get_height());
+		CHECK(loaded->get_number_of_mines() == game.get_number_of_mines());
+		CHECK(loaded->get_seed() == game.get_seed());
+		CHECK(loaded->state() == game.state());
+		CHECK(loaded->revealed_cells() == game.revealed_cells());
+		CHECK(loaded->board_digest() == game.board_digest());
+	}
+	unlink(path.c_str());
+
+	// Anything that isn't a snapshot is refused
+	FILE* file = fopen(path.c_str(), "wb");
+	fputs("not a snapshot", file);
+	fclose(file);
+	bool refused = false;
+	try {
+		load_snapshot(path);
+	}
+	catch (const Invalid_Snapshot&) {
+		refused = true;
+	}
+	CHECK(refused);
+	unlink(path.c_str());
+}
+
+// EFFECTS: Checks that the solver finishes games loaded from snapshots
+// with the player's flags (right or wrong) still on the board
+void test_solver_with_loaded_flags(void) {
+	string path = temporary_path("flags.bin");
+	for (uint64_t seed = 1; seed <= 50; ++seed) {
+		Minesweeper_Game game(9, 9, 10);
+		game.set_first_click_safe(true);
+		game.new_game(seed);
+		game.reveal(4, 4);
+		for (int row = 0; row < game.get_height(); ++row) {
+			game.flag(row, 0);
+			game.flag(row, game.get_width() - 1);
+		}
+		save_snapshot(game, path);
+		unique_ptr<Minesweeper_Game> loaded = load_snapshot(path);
+		Minesweeper_Solver solver(seed % 2 == 0);
+		solver.new_game(*loaded, seed);
+		// Every tile can take at most a flag, taking it off, and a reveal
+		int moves_left = 3 * game.get_width() * game.get_height();
+		while (loaded->state() == Game_State::IN_PROGRESS && moves_left-- > 0) {
+			CHECK(solver.play_move(*loaded).status == Move_Status::OK);
+		}
+		CHECK(loaded->state() != Game_State::IN_PROGRESS);
+	}
+	unlink(path.c_str());
+}
+
+// EFFECTS: Records whole games with every kind of move, then checks that
+// replaying each log makes the same game
+void test_move_log_round_trip(void) {
+	string path = temporary_path("game.log");
+	for (uint64_t seed = 1; seed <= 20; ++seed) {
+		Minesweeper_Game game(16, 16, 40);
+		game.set_first_click_safe(seed % 2 == 0);
+		game.new_game(seed);
+		uint64_t moves = 0;
+		{
+			Move_Log_Writer log(path);
+			// A question mark taken off again, then the solver plays the rest
+			game.question(0, 0);
+			log.record(game);
+			game.question(0, 0);
+			log.record(game);
+			moves += 2;
+			Minesweeper_Solver solver(true);
+			solver.new_game(game, seed);
+			while (game.state() == Game_State::IN_PROGRESS) {
+				if (solver.play_move(game).status != Move_Status::OK) continue;
+				log.record(game);
+				++moves;
+			}
+			log.finish(game);
+		}
+		Replay_Results results = replay_move_log(path);
+		CHECK(results.ok());
+		CHECK(results.has_final_state);
+		CHECK(results.moves == moves);
+		CHECK(results.state == game.state());
+	}
+
+	// A no-guess board changes the seed on the first reveal, after a flag
+	// or question mark may already have been recorded
+	for (uint64_t seed = 1; seed <= 20; ++seed) {
+		Minesweeper_Game game(16, 16, 40);
+		game.set_first_click_safe(true);
+		game.new_game(seed);
+		{
+			Move_Log_Writer log(path);
+			game.flag(0, 0);
+			log.record(game);
+			log.flush();
+			game.question(0, 0);
+			log.record(game);
+			game.set_seed(seed * 1000003);
+			game.reveal(8, 8);
+			log.record(game);
+			Minesweeper_Solver solver(true);
+			solver.new_game(game, seed);
+			while (game.state() == Game_State::IN_PROGRESS) {
+				if (solver.play_move(game).status == Move_Status::OK) log.record(game);
+			}
+			log.finish(game);
+		}
+		Replay_Results results = replay_move_log(path);
+		CHECK(results.ok());
+		CHECK(results.has_final_state);
+	}
+
+	// A log that doesn't end in the game it was written with is caught (the
+	// flag is logged twice, so the replay takes it off again)
+	{
+		Minesweeper_Game game(9, 9, 10);
+		game.new_game(3);
+		Move_Log_Writer log(path);
+		game.flag(0, 0);
+		log.record(game);
+		log.record(game);
+		log.finish(game);
+	}
+	Replay_Results results = replay_move_log(path);
+	CHECK(!results.ok());
+	unlink(path.c_str());
+}
+
+// Main function
+int main() {
+	test_reveal();
+	test_chord();
+	test_nearby_mine_counts();
+	test_no_allocations_between_games();
+	test_snapshot_round_trip();
+	test_solver_with_loaded_flags();
+	test_move_log_round_trip();
+	if (failures > 0) {
+		cout << failures << " checks failed" << endl;
+		return 1;
+	}
+	cout << "All tests passed" << endl;
+	return 0;
+}
@@ -0,0 +1,184 @@
+// Minesweeper
+// By: Benjamin Yee
+// Email: yeebenja@umich.edu
+// LinkedIn: https://www.linkedin.com/in/yeebenja
+// GitHub: https://github.com/yeebenja
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread Pool Class
+// A fixed set of worker threads that run parallel_for() jobs. Each job's range
+// of indexes is split evenly between the workers up front. A worker takes
+// small chunks from the front of its own range, and when its range runs out it
+// steals the back half of another worker's range, so workers that get slow
+// chunks don't hold up the others.
+// The thread that calls parallel_for() works too, as the last worker.
+class Thread_Pool {
+public:
+	// Work function: runs indexes [begin, end) on worker number worker
+	typedef std::function<void(unsigned worker, size_t begin, size_t end)> Job;
+
+private:
+	// Indexes a worker has left to run
+	// Note: Aligned to a cache line so workers don't slow each other down
+	struct alignas(64) Work_Range {
+		std::mutex lock;
+		size_t begin;
+		size_t end;
+	};
+
+	std::vector<std::thread> threads;
+	std::vector<std::unique_ptr<Work_Range>> ranges;	// One per worker
+
+	std::mutex lock;					// Guards everything below
+	std::condition_variable job_ready;	// Signalled when a job starts or the pool stops
+	std::condition_variable job_done;	// Signalled when the last worker finishes a job
+	const Job* job;				// Job being run
+	size_t chunk_size;			// Number of indexes a worker takes at a time
+	unsigned long long job_number;	// Increases each time a job starts
+	unsigned busy_workers;		// Number of threads still working on the job
+	bool stopping;
+
+public:
+
+	// Default Constructor: One worker per hardware thread
+	Thread_Pool() : Thread_Pool(std::thread::hardware_concurrency()) {}
+
+	// Custom Constructor: Specify number of workers (at least 1)
+	explicit Thread_Pool(unsigned number_of_workers) : job(nullptr), chunk_size(1),
+		job_number(0), busy_workers(0), stopping(false) {
+		number_of_workers = std::max(1u, number_of_workers);
+		for (unsigned i = 0; i < number_of_workers; ++i) {
+			ranges.emplace_back(new Work_Range);
+			ranges.back()->begin = 0;
+			ranges.back()->end = 0;
+		}
+		for (unsigned i = 0; i + 1 < number_of_workers; ++i) {
+			threads.emplace_back(&Thread_Pool::worker_thread, this, i);
+		}
+	}
+
+	// Destructor
+	~Thread_Pool() {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopping = true;
+		}
+		job_ready.notify_all();
+		for (std::thread& t : threads) t.join();
+	}
+
+	Thread_Pool(const Thread_Pool&) = delete;
+	Thread_Pool& operator=(const Thread_Pool&) = delete;
+
+	// EFFECTS: Returns number of workers, including the calling thread
+	unsigned size(void) const {
+		return unsigned(ranges.size());
+	}
+
+	// REQUIRES: body doesn't throw, and isn't called from inside another job
+	// EFFECTS: Runs body on every index in [0, count), taking chunk indexes at
+	// a time, and returns once all of them are done. Worker numbers passed to
+	// body are in [0, size()), and no two chunks run at the same time on the
+	// same worker number, so body can keep per-worker state.
+	void parallel_for(size_t count, size_t chunk, const Job& body) {
+		if (count == 0) return;
+		size_t workers = ranges.size();
+		for (size_t i = 0; i < workers; ++i) {
+			std::lock_guard<std::mutex> guard(ranges[i]->lock);
+			ranges[i]->begin = count * i / workers;
+			ranges[i]->end = count * (i + 1) / workers;
+		}
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			job = &body;
+			chunk_size = std::max(size_t(1), chunk);
+			busy_workers = unsigned(threads.size());
+			++job_number;
+		}
+		job_ready.notify_all();
+		run_job(unsigned(workers - 1));
+		std::unique_lock<std::mutex> guard(lock);
+		job_done.wait(guard, [this] { return busy_workers == 0; });
+		job = nullptr;
+	}
+
+private:
+	// EFFECTS: Waits for jobs and works on them until the pool stops
+	void worker_thread(unsigned worker) {
+		unsigned long long jobs_seen = 0;
+		while (1) {
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				job_ready.wait(guard, [&] { return stopping || job_number != jobs_seen; });
+				if (stopping) return;
+				jobs_seen = job_number;
+			}
+			run_job(worker);
+			std::lock_guard<std::mutex> guard(lock);
+			if (--busy_workers == 0) job_done.notify_one();
+		}
+	}
+
+	// EFFECTS: Runs chunks of the current job until there is no work left
+	void run_job(unsigned worker) {
+		size_t begin, end;
+		while (take_work(worker, begin, end)) (*job)(worker, begin, end);
+	}
+
+	// EFFECTS: Takes the next chunk for worker from its own range, stealing
+	// half of another worker's range first if its own is empty. Returns false
+	// once there is no work left anywhere.
+	bool take_work(unsigned worker, size_t& begin, size_t& end) {
+		Work_Range& own = *ranges[worker];
+		while (1) {
+			{
+				std::lock_guard<std::mutex> guard(own.lock);
+				if (own.begin < own.end) {
+					begin = own.begin;
+					end = std::min(own.end, begin + chunk_size);
+					own.begin = end;
+					return true;
+				}
+			}
+			if (!steal_work(worker)) return false;
+		}
+	}
+
+	// EFFECTS: Moves the back half of another worker's range into worker's
+	// range. Returns false if every other range is empty.
+	bool steal_work(unsigned worker) {
+		size_t workers = ranges.size();
+		for (size_t i = 1; i < workers; ++i) {
+			Work_Range& victim = *ranges[(worker + i) % workers];
+			size_t begin, end;
+			{
+				std::lock_guard<std::mutex> guard(victim.lock);
+				if (victim.begin >= victim.end) continue;
+				// Round down so a range of one index can still be stolen
+				size_t middle = victim.begin + (victim.end - victim.begin) / 2;
+				begin = middle;
+				end = victim.end;
+				victim.end = middle;
+			}
+			Work_Range& own = *ranges[worker];
+			std::lock_guard<std::mutex> guard(own.lock);
+			own.begin = begin;
+			own.end = end;
+			return true;
+		}
+		return false;
+	}
+};
+
+#endif